@@ -0,0 +1,46 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef BENCHFIXTURES_H
+#define BENCHFIXTURES_H
+
+#include <QGeoCoordinate>
+#include <QGeoRectangle>
+
+#include <array>
+#include <cmath>
+
+// Воспроизводимые viewport: окно 1920x1080 вокруг фиксированных городов на зумах из ZOOM_TO_H3_RES
+namespace BenchFixtures
+{
+    struct City {
+        const char *name;
+        double latitude;
+        double longitude;
+    };
+
+    inline constexpr std::array<City, 3> kCities{{
+        {"moscow", 55.7558, 37.6173},
+        {"saint_petersburg", 59.9311, 30.3609},
+        {"novosibirsk", 55.0084, 82.9357},
+    }};
+
+    inline constexpr int kMinZoom = 4;
+    inline constexpr int kMaxZoom = 24;
+    inline constexpr double kScreenWidth = 1920.0;
+    inline constexpr double kScreenHeight = 1080.0;
+    inline constexpr double kTileSize = 256.0;
+
+    inline QGeoRectangle viewport(const City &city, const int zoom, const double shiftDegrees = 0.0)
+    {
+        const double width = kScreenWidth / (kTileSize * std::pow(2.0, zoom)) * 360.0;
+        const double height = width * kScreenHeight / kScreenWidth * std::cos(city.latitude * M_PI / 180.0);
+
+        const QGeoCoordinate center(city.latitude, city.longitude + shiftDegrees);
+        return QGeoRectangle(QGeoCoordinate(center.latitude() + height / 2, center.longitude() - width / 2),
+                             QGeoCoordinate(center.latitude() - height / 2, center.longitude() + width / 2));
+    }
+} // namespace BenchFixtures
+
+#endif //BENCHFIXTURES_H
@@ -0,0 +1,464 @@
+//
+// Created by user on 10/18/26.
+//
+
+// Микробенчмарки слоя приложения поверх H3: модель, менеджер данных, цвета.
+// JSON: h3-viewer-bench --benchmark_out=results.json --benchmark_out_format=json
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QThread>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include "benchFixtures.h"
+#include "h3FlatMap.h"
+#include "h3PackedGeometry.h"
+#include "h3SortedIndex.h"
+#include "h3TaskScheduler.h"
+#include "h3TopologyMesh.h"
+#include "h3datamanager.h"
+#include "h3model.h"
+#include "h3rastergenerator.h"
+#include "h3tilegenerator.h"
+#include "tileMath.h"
+
+namespace
+{
+    using BenchFixtures::kCities;
+
+    H3Index cellAt(const BenchFixtures::City& city, const int resolution)
+    {
+        const LatLng point{degsToRads(city.latitude), degsToRads(city.longitude)};
+        H3Index cell = 0;
+        latLngToCell(&point, resolution, &cell);
+        return cell;
+    }
+
+    // Соседние ячейки вокруг города - стабильный набор ключей для менеджера данных
+    std::vector<H3Index> diskAt(const BenchFixtures::City& city, const int resolution, const int k)
+    {
+        int64_t size = 0;
+        maxGridDiskSize(k, &size);
+        std::vector<H3Index> cells(size);
+        gridDisk(cellAt(city, resolution), k, cells.data());
+        std::erase(cells, 0);
+        return cells;
+    }
+
+    void BM_H3HexagonConstruction(benchmark::State& state)
+    {
+        const H3Index cell = cellAt(kCities[0], static_cast<int>(state.range(0)));
+        for (auto _ : state)
+        {
+            H3Hexagon hexagon(cell);
+            benchmark::DoNotOptimize(hexagon);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_H3HexagonConstruction)->DenseRange(0, 15);
+
+    // Каждая итерация - полный пересчёт: viewport попеременно сдвигается на малую величину
+    void BM_UpdateHexagons(benchmark::State& state)
+    {
+        const auto& city = kCities[state.range(0)];
+        const int zoom = static_cast<int>(state.range(1));
+
+        H3HexagonModel model;
+        model.setZoom(zoom);
+
+        const QGeoRectangle viewports[2] = {BenchFixtures::viewport(city, zoom),
+                                            BenchFixtures::viewport(city, zoom, 1e-7)};
+        int flip = 0;
+        for (auto _ : state)
+        {
+            model.setViewport(viewports[flip ^= 1]);
+        }
+
+        state.SetLabel(city.name);
+        state.counters["resolution"] = model.h3Resolution();
+        state.counters["cells"] = model.hexagonCount();
+        state.SetItemsProcessed(state.iterations() * model.hexagonCount());
+    }
+    BENCHMARK(BM_UpdateHexagons)
+        ->ArgsProduct({benchmark::CreateDenseRange(0, kCities.size() - 1, 1),
+                       benchmark::CreateDenseRange(BenchFixtures::kMinZoom, BenchFixtures::kMaxZoom, 1)})
+        ->Unit(benchmark::kMillisecond);
+
+    // Преобразование ролей в QVariant для всех строк, как при создании делегатов
+    void BM_ModelData(benchmark::State& state)
+    {
+        const int role = static_cast<int>(state.range(0));
+        constexpr int zoom = 12;
+
+        H3HexagonModel model;
+        model.setZoom(zoom);
+        model.setViewport(BenchFixtures::viewport(kCities[0], zoom));
+
+        const int rows = model.rowCount();
+        for (auto _ : state)
+        {
+            for (int row = 0; row < rows; ++row)
+            {
+                benchmark::DoNotOptimize(model.data(model.index(row), role));
+            }
+        }
+
+        state.SetLabel(model.roleNames().value(role).toStdString());
+        state.counters["rows"] = rows;
+        state.SetItemsProcessed(state.iterations() * rows);
+    }
+    BENCHMARK(BM_ModelData)
+        ->Arg(H3HexagonModel::IndexRole)
+        ->Arg(H3HexagonModel::CenterRole)
+        ->Arg(H3HexagonModel::BoundaryRole)
+        ->Arg(H3HexagonModel::PropertiesRole);
+
+    // Создание делегатов MapItemView на ~10k ячеек: каждый читает все роли строки.
+    // 0 - первое создание после пересчёта (кеш ролей пуст), 1 - повторная привязка (значения из кеша)
+    void BM_DelegateCreation(benchmark::State& state)
+    {
+        const bool warm = state.range(0) != 0;
+        constexpr int zoom = 12;
+        constexpr double kTargetCells = 10000.0;
+        const auto& city = kCities[0];
+
+        H3HexagonModel model;
+        model.setZoom(zoom);
+
+        // Квадрат площадью kTargetCells средних ячеек текущего разрешения
+        double cellArea = 0.0;
+        getHexagonAreaAvgKm2(model.h3Resolution(), &cellArea);
+        const double side = std::sqrt(kTargetCells * cellArea) / 111.32;
+        const QGeoCoordinate center(city.latitude, city.longitude);
+        const double width = side / std::cos(city.latitude * M_PI / 180.0);
+
+        int flip = 0;
+        const auto recompute = [&]
+        {
+            const QGeoCoordinate shifted(center.latitude(), center.longitude() + (flip ^= 1) * 1e-7);
+            model.setViewportFromCenter(shifted, width, side);
+        };
+        recompute();
+
+        const int roles[] = {H3HexagonModel::IndexRole, H3HexagonModel::CenterRole, H3HexagonModel::BoundaryRole,
+                             H3HexagonModel::PropertiesRole};
+        for (auto _ : state)
+        {
+            if (!warm)
+            {
+                state.PauseTiming();
+                recompute();
+                state.ResumeTiming();
+            }
+            const int rows = model.rowCount();
+            for (int row = 0; row < rows; ++row)
+            {
+                const QModelIndex index = model.index(row);
+                for (const int role : roles)
+                    benchmark::DoNotOptimize(model.data(index, role));
+            }
+        }
+
+        state.SetLabel(warm ? "rebind" : "create");
+        state.counters["rows"] = model.rowCount();
+        state.SetItemsProcessed(state.iterations() * model.rowCount());
+    }
+    BENCHMARK(BM_DelegateCreation)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+    void BM_SetHexagonData(benchmark::State& state)
+    {
+        const std::vector<H3Index> cells = diskAt(kCities[0], 9, static_cast<int>(state.range(0)));
+
+        H3DataManager manager;
+        H3Data data;
+        for (auto _ : state)
+        {
+            for (const H3Index cell : cells)
+            {
+                data.index = cell;
+                data.value += 1.0;
+                manager.setHexagonData(cell, data);
+            }
+        }
+
+        state.counters["cells"] = cells.size();
+        state.SetItemsProcessed(state.iterations() * cells.size());
+    }
+    BENCHMARK(BM_SetHexagonData)->Arg(10)->Arg(50);
+
+    void BM_AggregateToParent(benchmark::State& state)
+    {
+        const std::vector<H3Index> cells = diskAt(kCities[0], static_cast<int>(state.range(0)), 10);
+
+        H3DataManager manager;
+        for (auto _ : state)
+        {
+            for (const H3Index cell : cells)
+            {
+                manager.aggregateToParent(cell, 1.0);
+            }
+        }
+
+        state.counters["cells"] = cells.size();
+        state.SetItemsProcessed(state.iterations() * cells.size());
+    }
+    BENCHMARK(BM_AggregateToParent)->Arg(5)->Arg(9)->Arg(15);
+
+    void BM_ValueToColor(benchmark::State& state)
+    {
+        double value = 0.0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(H3DataManager::valueToColor(value, 0.0, 1.0));
+            value = value >= 1.0 ? 0.0 : value + 0.001;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ValueToColor);
+
+    // Таблицы с ключом H3Index: H3FlatMap против прежних std::unordered_map и QHash.
+    // Ключи - диск ячеек разрешения 9, поиск в перемешанном порядке, как при обращениях делегатов
+    using FlatIndexMap = H3FlatMap<size_t>;
+    using StdIndexMap = std::unordered_map<H3Index, size_t>;
+
+    template <typename Map>
+    void BM_MapFind(benchmark::State& state)
+    {
+        const std::vector<H3Index> cells = diskAt(kCities[0], 9, static_cast<int>(state.range(0)));
+        std::vector<H3Index> lookups = cells;
+        std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64(42));
+
+        Map map;
+        for (size_t i = 0; i < cells.size(); ++i)
+            map[cells[i]] = i;
+
+        for (auto _ : state)
+        {
+            size_t sum = 0;
+            for (const H3Index cell : lookups)
+                sum += map.find(cell)->second;
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.counters["cells"] = cells.size();
+        state.SetItemsProcessed(state.iterations() * lookups.size());
+    }
+    BENCHMARK(BM_MapFind<FlatIndexMap>)->Arg(20)->Arg(60)->Arg(300);
+    BENCHMARK(BM_MapFind<StdIndexMap>)->Arg(20)->Arg(60)->Arg(300);
+
+    void BM_QHashFind(benchmark::State& state)
+    {
+        const std::vector<H3Index> cells = diskAt(kCities[0], 9, static_cast<int>(state.range(0)));
+        std::vector<H3Index> lookups = cells;
+        std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64(42));
+
+        QHash<H3Index, size_t> map;
+        for (size_t i = 0; i < cells.size(); ++i)
+            map.insert(cells[i], i);
+
+        for (auto _ : state)
+        {
+            size_t sum = 0;
+            for (const H3Index cell : lookups)
+                sum += map.find(cell).value();
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.counters["cells"] = cells.size();
+        state.SetItemsProcessed(state.iterations() * lookups.size());
+    }
+    BENCHMARK(BM_QHashFind)->Arg(20)->Arg(60)->Arg(300);
+
+    // Построение индекса строк, как в H3HexagonModel::computeHexagons
+    template <typename Map>
+    void BM_MapBuild(benchmark::State& state)
+    {
+        const std::vector<H3Index> cells = diskAt(kCities[0], 9, static_cast<int>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            Map map;
+            map.reserve(cells.size());
+            for (size_t i = 0; i < cells.size(); ++i)
+                map[cells[i]] = i;
+            benchmark::DoNotOptimize(map);
+        }
+
+        state.counters["cells"] = cells.size();
+        state.SetItemsProcessed(state.iterations() * cells.size());
+    }
+    BENCHMARK(BM_MapBuild<FlatIndexMap>)->Arg(20)->Arg(60)->Arg(300);
+    BENCHMARK(BM_MapBuild<StdIndexMap>)->Arg(20)->Arg(60)->Arg(300);
+
+    std::vector<H3SortedIndex::Entry> shuffledEntries(const int k)
+    {
+        std::vector<H3SortedIndex::Entry> entries;
+        for (const H3Index cell : diskAt(kCities[0], 9, k))
+            entries.push_back({cell, 1.0});
+        std::shuffle(entries.begin(), entries.end(), std::mt19937_64(42));
+        return entries;
+    }
+
+    // Поразрядная сортировка с пропуском постоянных байтов
+    void BM_SortedIndexBuild(benchmark::State& state)
+    {
+        const std::vector<H3SortedIndex::Entry> entries = shuffledEntries(static_cast<int>(state.range(0)));
+
+        H3SortedIndex index;
+        for (auto _ : state)
+            index.build(entries);
+
+        state.counters["cells"] = entries.size();
+        state.SetItemsProcessed(state.iterations() * entries.size());
+    }
+    BENCHMARK(BM_SortedIndexBuild)->Arg(60)->Arg(300)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+    // Свёртка разрешения 9 к 5 одним проходом по отсортированному массиву
+    void BM_SortedIndexRollup(benchmark::State& state)
+    {
+        H3SortedIndex index;
+        index.build(shuffledEntries(static_cast<int>(state.range(0))));
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(index.rollup(9, 5));
+
+        state.counters["cells"] = index.size();
+        state.SetItemsProcessed(state.iterations() * index.size());
+    }
+    BENCHMARK(BM_SortedIndexRollup)->Arg(60)->Arg(300);
+
+    // Общие вершины и рёбра набора; счётчики сравнивают с отдельными контурами на каждую ячейку
+    void BM_TopologyMeshBuild(benchmark::State& state)
+    {
+        const std::vector<H3Index> cells = diskAt(kCities[0], 9, static_cast<int>(state.range(0)));
+
+        H3TopologyMesh mesh;
+        for (auto _ : state)
+            mesh.build(cells);
+
+        size_t ringVertices = 0;
+        for (size_t cell = 0; cell < mesh.cellCount(); ++cell)
+            ringVertices += mesh.cellRing(cell).size();
+
+        state.counters["cells"] = cells.size();
+        state.counters["vertices"] = mesh.vertices().size();
+        state.counters["ringVertices"] = ringVertices;
+        state.counters["edges"] = mesh.edges().size();
+        state.counters["bytes"] = mesh.memoryBytes();
+        state.SetItemsProcessed(state.iterations() * cells.size());
+    }
+    BENCHMARK(BM_TopologyMeshBuild)->Arg(20)->Arg(60)->Arg(300)->Unit(benchmark::kMillisecond);
+
+    // Упаковка меша в float32 буферы тайлов зума 14 (ячейки разрешения 9)
+    void BM_PackedGeometryBuild(benchmark::State& state)
+    {
+        H3TopologyMesh mesh;
+        mesh.build(diskAt(kCities[0], 9, static_cast<int>(state.range(0))));
+
+        H3PackedGeometry geometry;
+        for (auto _ : state)
+            geometry.build(mesh, 14);
+
+        state.counters["cells"] = mesh.cellCount();
+        state.counters["tiles"] = geometry.tiles().size();
+        state.counters["bytes"] = geometry.memoryBytes();
+        state.SetItemsProcessed(state.iterations() * mesh.cellCount());
+    }
+    BENCHMARK(BM_PackedGeometryBuild)->Arg(20)->Arg(60)->Arg(300)->Unit(benchmark::kMillisecond);
+
+    // Растровый тайл обзорного зума вокруг города: заливка и рёбра полосами в пуле потоков
+    void BM_RasterTile(benchmark::State& state)
+    {
+        const int z = static_cast<int>(state.range(0));
+        const auto& city = kCities[0];
+        const int x = static_cast<int>(TileMath::lngToTileX(city.longitude, z));
+        const int y = static_cast<int>(TileMath::latToTileY(city.latitude, z));
+
+        const H3RasterTileGenerator generator(nullptr);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(generator.renderTile(z, x, y));
+
+        state.counters["cells"] = H3TileGenerator::cellsInTile(z, x, y, H3HexagonModel::resolutionForZoom(z)).size();
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_RasterTile)->DenseRange(4, H3RasterTileGenerator::kMaxZoom, 2)->Unit(benchmark::kMillisecond);
+
+    // Ячейки обзорного тайла: до зума 6 берутся из таблиц разрешений 0-2, дальше - полифилл
+    void BM_CoarseTileCells(benchmark::State& state)
+    {
+        const int z = static_cast<int>(state.range(0));
+        const auto& city = kCities[0];
+        const int x = static_cast<int>(TileMath::lngToTileX(city.longitude, z));
+        const int y = static_cast<int>(TileMath::latToTileY(city.latitude, z));
+        const int resolution = H3HexagonModel::resolutionForZoom(z);
+
+        size_t cells = 0;
+        for (auto _ : state)
+        {
+            cells = H3TileGenerator::cellsInTile(z, x, y, resolution).size();
+            benchmark::DoNotOptimize(cells);
+        }
+
+        state.counters["cells"] = cells;
+        state.counters["resolution"] = resolution;
+        state.SetItemsProcessed(state.iterations() * cells);
+    }
+    BENCHMARK(BM_CoarseTileCells)->DenseRange(4, 8);
+
+    // Ожидание задачи видимой области за очередью массовой загрузки: класс Ingest ограничен
+    // половиной потоков, поэтому Interactive стартует без ожидания всей очереди
+    void BM_SchedulerInteractiveWait(benchmark::State& state)
+    {
+        const int backlog = static_cast<int>(state.range(0));
+        H3TaskScheduler scheduler(QThread::idealThreadCount());
+
+        for (auto _ : state)
+        {
+            for (int i = 0; i < backlog; ++i)
+            {
+                scheduler.submit(TaskPriority::Ingest,
+                                 [](const CancellationToken& token)
+                                 {
+                                     if (!token.isCancelled())
+                                         std::this_thread::sleep_for(std::chrono::microseconds(200));
+                                 });
+            }
+
+            std::atomic<bool> done{false};
+            const auto start = std::chrono::steady_clock::now();
+            scheduler.submit(TaskPriority::Interactive, [&done](const CancellationToken&) { done.store(true); });
+            while (!done.load())
+                std::this_thread::yield();
+            state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+            scheduler.cancelQueued(TaskPriority::Ingest);
+            scheduler.waitForDone();
+        }
+
+        const H3TaskScheduler::ClassStats ingest = scheduler.stats(TaskPriority::Ingest);
+        state.counters["ingestCancelled"] = ingest.cancelled;
+        state.counters["ingestMaxWaitMs"] = ingest.maxWaitNs / 1e6;
+    }
+    BENCHMARK(BM_SchedulerInteractiveWait)->Arg(100)->Arg(1000)->UseManualTime()->Unit(benchmark::kMicrosecond);
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,284 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "benchmarkDriver.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+
+#include <algorithm>
+
+#include "h3model.h"
+
+namespace
+{
+    constexpr int kSettleMs = 2000;         // Запас на последнее обновление после траектории
+    constexpr int kStartTimeoutMs = 30000;  // Карта так и не стала готовой - бенчмарк провален
+
+    double percentileMs(QList<qint64> values, const double percentile)
+    {
+        if (values.isEmpty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        const auto index = static_cast<qsizetype>(percentile * (values.size() - 1) + 0.5);
+        return values[std::clamp<qsizetype>(index, 0, values.size() - 1)] / 1e6;
+    }
+
+    double averageMs(const QList<qint64>& values)
+    {
+        if (values.isEmpty())
+            return 0.0;
+
+        double total = 0.0;
+        for (const qint64 value : values)
+            total += value;
+        return total / values.size() / 1e6;
+    }
+
+    QJsonObject distribution(const QList<qint64>& values)
+    {
+        return QJsonObject{{"count", values.size()},
+                           {"avgMs", averageMs(values)},
+                           {"p50Ms", percentileMs(values, 0.50)},
+                           {"p95Ms", percentileMs(values, 0.95)},
+                           {"p99Ms", percentileMs(values, 0.99)},
+                           {"maxMs", percentileMs(values, 1.0)}};
+    }
+
+    QString graphicsApiName(const QSGRendererInterface::GraphicsApi api)
+    {
+        switch (api)
+        {
+        case QSGRendererInterface::Software:
+            return "software";
+        case QSGRendererInterface::OpenGLRhi:
+            return "opengl";
+        case QSGRendererInterface::VulkanRhi:
+            return "vulkan";
+        default:
+            return QString::number(static_cast<int>(api));
+        }
+    }
+} // namespace
+
+BenchmarkDriver::BenchmarkDriver(QQuickWindow* window, QString reportPath, QObject* parent) :
+    QObject(parent), m_window(window), m_reportPath(std::move(reportPath)), m_trajectory(defaultTrajectory())
+{
+    m_map = window->findChild<QObject*>("map");
+    m_model = window->findChild<H3HexagonModel*>();
+
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(kSettleMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &BenchmarkDriver::finish);
+
+    // Кадры отмечаем в потоке GUI - так отчёт одинаков для basic и threaded render loop
+    connect(window, &QQuickWindow::frameSwapped, this, &BenchmarkDriver::onFrameSwapped, Qt::QueuedConnection);
+
+    if (m_model)
+    {
+        connect(m_model, &H3HexagonModel::updateStarted, this, [this]() { m_updateStartNs = m_clock.nsecsElapsed(); });
+        connect(m_model, &H3HexagonModel::updateFinished, this,
+                [this]()
+                {
+                    if (!m_running || m_updateStartNs < 0)
+                        return;
+
+                    const qint64 now = m_clock.nsecsElapsed();
+                    m_updates.append({m_updateStartNs, m_pendingMoveNs >= 0 ? now - m_pendingMoveNs : 0,
+                                      now - m_updateStartNs, m_model->hexagonCount()});
+                    m_pendingMoveNs = -1;
+                    m_updateStartNs = -1;
+                });
+    }
+}
+
+bool BenchmarkDriver::loadTrajectory(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    // [{"lat": 55.75, "lng": 37.61, "zoom": 10, "steps": 60}, ...]
+    const QJsonArray points = QJsonDocument::fromJson(file.readAll()).array();
+    QList<Keyframe> trajectory;
+    for (qsizetype i = 0; i < points.size(); ++i)
+    {
+        const QJsonObject point = points[i].toObject();
+        trajectory.append({QGeoCoordinate(point.value("lat").toDouble(), point.value("lng").toDouble()),
+                           point.value("zoom").toDouble(10.0), std::max(1, point.value("steps").toInt(60))});
+    }
+
+    if (trajectory.isEmpty())
+        return false;
+
+    m_trajectory = trajectory;
+    return true;
+}
+
+QList<BenchmarkDriver::Keyframe> BenchmarkDriver::defaultTrajectory()
+{
+    return {
+        {QGeoCoordinate(55.7558, 37.6173), 10.0, 1},   // Москва
+        {QGeoCoordinate(55.7558, 37.6173), 14.0, 120}, // Приближение
+        {QGeoCoordinate(55.7558, 37.7500), 14.0, 120}, // Панорамирование на восток
+        {QGeoCoordinate(55.7000, 37.7500), 14.5, 60},
+        {QGeoCoordinate(55.7558, 37.6173), 8.0, 90},   // Отдаление
+        {QGeoCoordinate(59.9311, 30.3609), 8.0, 120},  // Санкт-Петербург
+        {QGeoCoordinate(59.9311, 30.3609), 16.0, 120},
+        {QGeoCoordinate(59.9400, 30.3200), 16.0, 60},
+    };
+}
+
+void BenchmarkDriver::start()
+{
+    if (!m_window || !m_map || !m_model)
+    {
+        qWarning() << "Benchmark: map or h3 model not found in main.qml";
+        QCoreApplication::exit(1);
+        return;
+    }
+
+    qInfo() << "Benchmark: platform" << QGuiApplication::platformName() << "graphics"
+            << graphicsApiName(m_window->rendererInterface()->graphicsApi()) << "keyframes" << m_trajectory.size();
+
+    QTimer::singleShot(kStartTimeoutMs, this,
+                       [this]()
+                       {
+                           if (m_running)
+                               return;
+                           qWarning() << "Benchmark: map did not become ready";
+                           QCoreApplication::exit(1);
+                       });
+
+    m_clock.start();
+    m_window->update();
+}
+
+void BenchmarkDriver::onFrameSwapped()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+
+    if (m_running)
+    {
+        m_frames.append({now, m_lastFrameNs >= 0 ? now - m_lastFrameNs : 0,
+                         m_map->property("center").value<QGeoCoordinate>(), m_map->property("zoomLevel").toDouble(),
+                         m_model->hexagonCount()});
+    }
+    m_lastFrameNs = now;
+
+    advance();
+}
+
+void BenchmarkDriver::advance()
+{
+    if (!m_window)
+        return;
+
+    if (!m_running)
+    {
+        // Ждём, пока main.qml отработает отложенную инициализацию карты
+        if (!m_map->property("mapReady").toBool())
+        {
+            m_window->update();
+            return;
+        }
+        m_running = true;
+        m_keyframe = 0;
+        m_step = 0;
+    }
+
+    if (m_keyframe >= m_trajectory.size())
+    {
+        // Траектория пройдена: дорисовываем кадры, пока не сработает m_settleTimer
+        if (m_settleTimer.isActive())
+            m_window->update();
+        return;
+    }
+
+    const Keyframe& target = m_trajectory[m_keyframe];
+    const Keyframe& from = m_keyframe > 0 ? m_trajectory[m_keyframe - 1] : target;
+    const double t = static_cast<double>(++m_step) / target.steps;
+
+    const QGeoCoordinate center(from.center.latitude() + (target.center.latitude() - from.center.latitude()) * t,
+                                from.center.longitude() + (target.center.longitude() - from.center.longitude()) * t);
+    m_map->setProperty("center", QVariant::fromValue(center));
+    m_map->setProperty("zoomLevel", from.zoom + (target.zoom - from.zoom) * t);
+
+    if (m_pendingMoveNs < 0)
+        m_pendingMoveNs = m_clock.nsecsElapsed();
+
+    if (m_step >= target.steps)
+    {
+        ++m_keyframe;
+        m_step = 0;
+        if (m_keyframe >= m_trajectory.size())
+            m_settleTimer.start();
+    }
+
+    m_window->update();
+}
+
+void BenchmarkDriver::finish()
+{
+    const bool written = writeReport();
+    if (written)
+        qInfo() << "Benchmark:" << m_frames.size() << "frames," << m_updates.size() << "updates, report"
+                << m_reportPath;
+    else
+        qWarning() << "Benchmark: failed to write report" << m_reportPath;
+
+    QCoreApplication::exit(written ? 0 : 1);
+}
+
+bool BenchmarkDriver::writeReport() const
+{
+    QList<qint64> frameTimes;
+    QJsonArray frames;
+    for (const Frame& frame : m_frames)
+    {
+        if (frame.frameNs > 0)
+            frameTimes.append(frame.frameNs);
+        frames.append(QJsonObject{{"timeMs", frame.timeNs / 1e6},
+                                  {"frameMs", frame.frameNs / 1e6},
+                                  {"lat", frame.center.latitude()},
+                                  {"lng", frame.center.longitude()},
+                                  {"zoom", frame.zoom},
+                                  {"cells", frame.cells}});
+    }
+
+    QList<qint64> latencies;
+    QList<qint64> computeTimes;
+    QJsonArray updates;
+    for (const Update& update : m_updates)
+    {
+        latencies.append(update.latencyNs);
+        computeTimes.append(update.computeNs);
+        updates.append(QJsonObject{{"startMs", update.startNs / 1e6},
+                                   {"latencyMs", update.latencyNs / 1e6},
+                                   {"computeMs", update.computeNs / 1e6},
+                                   {"cells", update.cells}});
+    }
+
+    const QJsonObject report{
+        {"platform", QGuiApplication::platformName()},
+        {"graphicsApi", m_window ? graphicsApiName(m_window->rendererInterface()->graphicsApi()) : QString()},
+        {"summary", QJsonObject{{"frames", distribution(frameTimes)},
+                                {"updateLatency", distribution(latencies)},
+                                {"updateCompute", distribution(computeTimes)}}},
+        {"frames", frames},
+        {"updates", updates}};
+
+    QFile file(m_reportPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(QJsonDocument(report).toJson()) >= 0;
+}
@@ -0,0 +1,79 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef BENCHMARKDRIVER_H
+#define BENCHMARKDRIVER_H
+
+#include <QElapsedTimer>
+#include <QGeoCoordinate>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class QQuickWindow;
+class H3HexagonModel;
+
+// Сквозной бенчмарк: ведёт карту main.qml по заданной траектории кадр за кадром
+// и пишет в JSON время каждого кадра и задержку обновления гексагонов
+class BenchmarkDriver : public QObject {
+    Q_OBJECT
+
+public:
+    // Точка траектории; steps - за сколько кадров доехать до неё от предыдущей
+    struct Keyframe {
+        QGeoCoordinate center;
+        double zoom;
+        int steps;
+    };
+
+    BenchmarkDriver(QQuickWindow *window, QString reportPath, QObject *parent = nullptr);
+
+    // Пустой путь - траектория по умолчанию
+    bool loadTrajectory(const QString &path);
+    void start();
+
+    static QList<Keyframe> defaultTrajectory();
+
+private:
+    struct Frame {
+        qint64 timeNs;
+        qint64 frameNs;
+        QGeoCoordinate center;
+        double zoom;
+        int cells;
+    };
+
+    struct Update {
+        qint64 startNs;
+        qint64 latencyNs; // От первого движения камеры после прошлого обновления
+        qint64 computeNs; // updateStarted..updateFinished
+        int cells;
+    };
+
+    void onFrameSwapped();
+    void advance();
+    void finish();
+    bool writeReport() const;
+
+    QPointer<QQuickWindow> m_window;
+    QPointer<QObject> m_map;
+    QPointer<H3HexagonModel> m_model;
+    QString m_reportPath;
+    QList<Keyframe> m_trajectory;
+
+    QElapsedTimer m_clock;
+    QTimer m_settleTimer; // После траектории ждём последнего обновления
+    bool m_running{false};
+    int m_keyframe{0};
+    int m_step{0};
+    qint64 m_lastFrameNs{-1};
+    qint64 m_pendingMoveNs{-1};
+    qint64 m_updateStartNs{-1};
+
+    QList<Frame> m_frames;
+    QList<Update> m_updates;
+};
+
+#endif //BENCHMARKDRIVER_H
@@ -0,0 +1,215 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "delegatePool.h"
+
+#include <QDebug>
+#include <QQmlContext>
+#include <QQmlEngine>
+
+#include <algorithm>
+
+#include "instrumentation.h"
+
+H3DelegatePool::H3DelegatePool(QObject* parent) : QObject(parent) {}
+
+void H3DelegatePool::setModel(QAbstractItemModel* model)
+{
+    if (m_model == model)
+        return;
+
+    for (const QMetaObject::Connection& connection : std::as_const(m_modelConnections))
+        disconnect(connection);
+    m_modelConnections.clear();
+
+    m_model = model;
+    // Другие роли - соответствие свойствам ищем заново
+    m_bindings.clear();
+    m_bindingsResolved = false;
+
+    connectModel();
+    emit modelChanged();
+    sync();
+}
+
+void H3DelegatePool::setDelegate(QQmlComponent* delegate)
+{
+    if (m_delegate == delegate)
+        return;
+
+    // Экземпляры другого компонента переиспользовать нельзя
+    clearItems();
+    m_delegate = delegate;
+    m_bindings.clear();
+    m_bindingsResolved = false;
+
+    emit delegateChanged();
+    sync();
+}
+
+void H3DelegatePool::setVisible(const bool visible)
+{
+    if (m_visible == visible)
+        return;
+
+    m_visible = visible;
+    for (QObject* item : m_active)
+        item->setProperty("visible", m_visible);
+    emit visibleChanged();
+}
+
+void H3DelegatePool::setMaxIdle(const int maxIdle)
+{
+    if (m_maxIdle == maxIdle || maxIdle < 0)
+        return;
+
+    m_maxIdle = maxIdle;
+    trimIdle();
+    emit maxIdleChanged();
+    emit statsChanged();
+}
+
+double H3DelegatePool::reuseRate() const
+{
+    const quint64 total = m_reused + m_created;
+    return total ? static_cast<double>(m_reused) / total : 0.0;
+}
+
+void H3DelegatePool::connectModel()
+{
+    if (!m_model)
+        return;
+
+    const auto resync = [this] { sync(); };
+    m_modelConnections = {
+        connect(m_model, &QAbstractItemModel::modelReset, this, resync),
+        connect(m_model, &QAbstractItemModel::rowsInserted, this, resync),
+        connect(m_model, &QAbstractItemModel::rowsRemoved, this, resync),
+        connect(m_model, &QAbstractItemModel::rowsMoved, this, resync),
+        connect(m_model, &QAbstractItemModel::layoutChanged, this, resync),
+        connect(m_model, &QAbstractItemModel::dataChanged, this, &H3DelegatePool::onDataChanged),
+        connect(m_model, &QObject::destroyed, this, resync),
+    };
+}
+
+void H3DelegatePool::sync()
+{
+    const size_t rows = m_model && m_delegate ? static_cast<size_t>(m_model->rowCount()) : 0;
+
+    // Лишние экземпляры прячутся в пул, недостающие берутся из пула или создаются
+    while (m_active.size() > rows)
+    {
+        QObject* item = m_active.back();
+        m_active.pop_back();
+        item->setProperty("visible", false);
+        m_idle.push_back(item);
+    }
+    m_active.reserve(rows);
+    while (m_active.size() < rows)
+    {
+        QObject* item = acquire();
+        if (!item)
+            break;
+        m_active.push_back(item);
+    }
+
+    if (!m_bindingsResolved && !m_active.empty())
+        resolveBindings(m_active.front());
+
+    // После сброса в строке может оказаться другая ячейка - перезаписываем все роли
+    for (size_t row = 0; row < m_active.size(); ++row)
+    {
+        bind(m_active[row], static_cast<int>(row));
+        m_active[row]->setProperty("visible", m_visible);
+    }
+
+    trimIdle();
+    emit statsChanged();
+}
+
+void H3DelegatePool::onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight,
+                                   const QList<int>& roles)
+{
+    const int last = std::min(bottomRight.row(), static_cast<int>(m_active.size()) - 1);
+    for (int row = std::max(topLeft.row(), 0); row <= last; ++row)
+        bind(m_active[row], row, roles);
+}
+
+QObject* H3DelegatePool::acquire()
+{
+    if (!m_idle.empty())
+    {
+        QObject* item = m_idle.back();
+        m_idle.pop_back();
+        ++m_reused;
+        H3_COUNTER_ADD(DelegatesReused, 1);
+        return item;
+    }
+
+    // Контекст, где объявлен компонент: делегату видны id и функции документа
+    QQmlContext* context = m_delegate->creationContext() ? m_delegate->creationContext() : qmlContext(this);
+    QObject* item = m_delegate->beginCreate(context);
+    if (!item)
+    {
+        qWarning() << "H3DelegatePool: failed to create delegate" << m_delegate->errors();
+        return nullptr;
+    }
+    item->setParent(this);
+    QQmlEngine::setObjectOwnership(item, QQmlEngine::CppOwnership);
+    m_delegate->completeCreate();
+
+    ++m_created;
+    H3_COUNTER_ADD(DelegatesCreated, 1);
+    emit itemCreated(item);
+    return item;
+}
+
+void H3DelegatePool::bind(QObject* item, const int row, const QList<int>& roles)
+{
+    const QModelIndex index = m_model->index(row, 0);
+    const QMetaObject* metaObject = item->metaObject();
+    for (const auto& [role, property] : m_bindings)
+    {
+        if (roles.isEmpty() || roles.contains(role))
+            metaObject->property(property).write(item, m_model->data(index, role));
+    }
+}
+
+void H3DelegatePool::resolveBindings(const QObject* item)
+{
+    m_bindings.clear();
+    const QHash<int, QByteArray> roleNames = m_model->roleNames();
+    for (auto it = roleNames.cbegin(); it != roleNames.cend(); ++it)
+    {
+        if (const int property = item->metaObject()->indexOfProperty(it.value().constData()); property >= 0)
+            m_bindings.emplace_back(it.key(), property);
+    }
+    m_bindingsResolved = true;
+}
+
+void H3DelegatePool::trimIdle()
+{
+    while (m_idle.size() > static_cast<size_t>(m_maxIdle))
+    {
+        destroyItem(m_idle.back());
+        m_idle.pop_back();
+    }
+}
+
+void H3DelegatePool::destroyItem(QObject* item)
+{
+    emit itemReleased(item);
+    item->deleteLater();
+}
+
+void H3DelegatePool::clearItems()
+{
+    for (QObject* item : m_active)
+        destroyItem(item);
+    for (QObject* item : m_idle)
+        destroyItem(item);
+    m_active.clear();
+    m_idle.clear();
+    emit statsChanged();
+}
@@ -0,0 +1,94 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef DELEGATEPOOL_H
+#define DELEGATEPOOL_H
+
+#include <QAbstractItemModel>
+#include <QObject>
+#include <QPointer>
+#include <QQmlComponent>
+
+#include <utility>
+#include <vector>
+
+// Замена MapItemView с переиспользованием делегатов. При сбросе модели объекты QML не уничтожаются:
+// строки получают экземпляры из пула и новые значения ролей, создаются только недостающие.
+// Роли пишутся в одноимённые свойства делегата (h3Index, boundary, ...), поэтому делегат объявляет
+// их как обычные свойства, а не читает model.*
+class H3DelegatePool : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QAbstractItemModel *model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QQmlComponent *delegate READ delegate WRITE setDelegate NOTIFY delegateChanged)
+    Q_PROPERTY(bool visible READ isVisible WRITE setVisible NOTIFY visibleChanged)
+    Q_PROPERTY(int maxIdle READ maxIdle WRITE setMaxIdle NOTIFY maxIdleChanged)
+    Q_PROPERTY(int poolSize READ poolSize NOTIFY statsChanged)
+    Q_PROPERTY(int activeCount READ activeCount NOTIFY statsChanged)
+    Q_PROPERTY(double reuseRate READ reuseRate NOTIFY statsChanged)
+
+public:
+    explicit H3DelegatePool(QObject *parent = nullptr);
+
+    QAbstractItemModel *model() const { return m_model; }
+    void setModel(QAbstractItemModel *model);
+
+    QQmlComponent *delegate() const { return m_delegate; }
+    void setDelegate(QQmlComponent *delegate);
+
+    // Видимость всех занятых делегатов; свободные скрыты всегда
+    bool isVisible() const { return m_visible; }
+    void setVisible(bool visible);
+
+    // Сколько свободных экземпляров держать про запас, лишние уничтожаются
+    int maxIdle() const { return m_maxIdle; }
+    void setMaxIdle(int maxIdle);
+
+    int poolSize() const { return static_cast<int>(m_active.size() + m_idle.size()); }
+    int activeCount() const { return static_cast<int>(m_active.size()); }
+
+    // Доля строк, получивших готовый экземпляр, за всё время
+    double reuseRate() const;
+
+signals:
+    void modelChanged();
+    void delegateChanged();
+    void visibleChanged();
+    void maxIdleChanged();
+    void statsChanged();
+
+    // Новый экземпляр: QML добавляет его на карту (map.addMapItem)
+    void itemCreated(QObject *item);
+    // Экземпляр будет уничтожен: QML убирает его с карты (map.removeMapItem)
+    void itemReleased(QObject *item);
+
+private:
+    void sync();
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
+    QObject *acquire();
+    void bind(QObject *item, int row, const QList<int> &roles = {});
+    void resolveBindings(const QObject *item);
+    void trimIdle();
+    void destroyItem(QObject *item);
+    void clearItems();
+    void connectModel();
+
+    QPointer<QAbstractItemModel> m_model;
+    QPointer<QQmlComponent> m_delegate;
+    QList<QMetaObject::Connection> m_modelConnections;
+
+    std::vector<QObject *> m_active; // По строкам модели
+    std::vector<QObject *> m_idle;
+
+    // Роль модели -> индекс свойства делегата, определяется по первому созданному экземпляру
+    std::vector<std::pair<int, int>> m_bindings;
+    bool m_bindingsResolved{false};
+
+    bool m_visible{true};
+    int m_maxIdle{4096};
+    quint64 m_reused{0};
+    quint64 m_created{0};
+};
+
+#endif //DELEGATEPOOL_H
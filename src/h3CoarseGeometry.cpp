@@ -0,0 +1,107 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3CoarseGeometry.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    constexpr int kResolutionShift = 52;
+    constexpr int kModeShift = 59;
+    constexpr H3Index kCellMode = 1;
+
+    int resolutionOf(const H3Index index) { return static_cast<int>((index >> kResolutionShift) & 0xF); }
+
+    // Поле разрешения выше базовой ячейки и цифр, поэтому отсортированная таблица идёт блоками по разрешениям
+    const std::array<size_t, H3CoarseGeometry::kMaxResolution + 2>& resolutionOffsets()
+    {
+        static const auto offsets = []
+        {
+            std::array<size_t, H3CoarseGeometry::kMaxResolution + 2> result{};
+            const H3CoarseGeometry::Cell* first = H3CoarseGeometry::detail::kCells;
+            const H3CoarseGeometry::Cell* last = first + H3CoarseGeometry::detail::kCellCount;
+            for (int resolution = 0; resolution <= H3CoarseGeometry::kMaxResolution + 1; ++resolution)
+            {
+                result[resolution] = std::partition_point(first, last,
+                                                          [resolution](const H3CoarseGeometry::Cell& cell)
+                                                          { return resolutionOf(cell.index) < resolution; }) -
+                    first;
+            }
+            return result;
+        }();
+        return offsets;
+    }
+
+    bool overlaps(const double aMin, const double aMax, const double bMin, const double bMax)
+    {
+        return aMin <= bMax && bMin <= aMax;
+    }
+} // namespace
+
+namespace H3CoarseGeometry
+{
+    const Cell* find(const H3Index index)
+    {
+        if ((index >> kModeShift & 0xF) != kCellMode || resolutionOf(index) > kMaxResolution)
+            return nullptr;
+
+        const std::span<const Cell> table = cells(resolutionOf(index));
+        const auto it = std::lower_bound(table.begin(), table.end(), index,
+                                         [](const Cell& cell, const H3Index value) { return cell.index < value; });
+        return it != table.end() && it->index == index ? &*it : nullptr;
+    }
+
+    std::span<const Cell> cells(const int resolution)
+    {
+        if (resolution < 0 || resolution > kMaxResolution)
+            return {};
+        const auto& offsets = resolutionOffsets();
+        return {detail::kCells + offsets[resolution], offsets[resolution + 1] - offsets[resolution]};
+    }
+
+    std::span<const Vertex> vertices() { return {detail::kVertices, detail::kVertexCount}; }
+
+    std::span<const uint32_t> ring(const Cell& cell) { return {detail::kRings + cell.ringOffset, cell.ringSize}; }
+
+    std::span<const Point> boundary(const Cell& cell)
+    {
+        return {detail::kBoundaryPoints + cell.boundaryOffset, cell.boundarySize};
+    }
+
+    bool crossesAntimeridian(const Cell& cell) { return cell.easternSize > 0; }
+
+    std::span<const Point> easternPart(const Cell& cell)
+    {
+        return {detail::kSplitPoints + cell.splitOffset, cell.easternSize};
+    }
+
+    std::span<const Point> westernPart(const Cell& cell)
+    {
+        return {detail::kSplitPoints + cell.splitOffset + cell.easternSize, cell.westernSize};
+    }
+
+    std::vector<H3Index> cellsInBounds(const int resolution, const double west, const double south,
+                                       const double east, const double north)
+    {
+        std::vector<H3Index> result;
+        for (const Cell& cell : cells(resolution))
+        {
+            if (!overlaps(cell.south, cell.north, south, north))
+                continue;
+
+            // Обе стороны развёрнуты независимо: сравниваем с копиями ячейки через ±360
+            for (const double shift : {0.0, -360.0, 360.0})
+            {
+                if (overlaps(cell.west + shift, cell.east + shift, west, east))
+                {
+                    result.push_back(cell.index);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+} // namespace H3CoarseGeometry
@@ -0,0 +1,80 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3COARSEGEOMETRY_H
+#define H3COARSEGEOMETRY_H
+
+#include <h3api.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Готовая геометрия всех ячеек разрешений 0-2 (122 + 842 + 5882). Таблицы генерирует h3-coarse-gen
+// из встроенной H3 при сборке, так что стартовые обзорные зумы не требуют вычислений H3.
+// Долготы в таблицах "развёрнуты": кольцо ячейки через антимеридиан идёт непрерывно и может выйти за 180
+namespace H3CoarseGeometry
+{
+    constexpr int kMaxResolution = 2;
+
+    struct Point {
+        double lat;
+        double lng;
+    };
+
+    // Вершина из vertex API: индекс нужен для объединения общих вершин соседних ячеек
+    struct Vertex {
+        H3Index index;
+        double lat;
+        double lng;
+    };
+
+    struct Cell {
+        H3Index index;
+        double lat; // Центр
+        double lng;
+        double west; // Ограничивающий прямоугольник; east может быть больше 180
+        double south;
+        double east;
+        double north;
+        uint32_t ringOffset; // Вершины vertex API в vertices()
+        uint32_t ringSize;
+        uint32_t boundaryOffset; // Контур cellToBoundary с точками искажения
+        uint32_t boundarySize;
+        uint32_t splitOffset; // Части контура по обе стороны антимеридиана, 0 точек - не пересекает
+        uint32_t easternSize;
+        uint32_t westernSize;
+    };
+
+    // nullptr, если ячейка мельче kMaxResolution или не ячейка
+    const Cell *find(H3Index index);
+    std::span<const Cell> cells(int resolution);
+
+    std::span<const Vertex> vertices();
+    std::span<const uint32_t> ring(const Cell &cell);
+    std::span<const Point> boundary(const Cell &cell);
+
+    // Полигоны ячейки, разрезанной по антимеридиану: восточная часть с долготами до 180
+    // и западная от -180. У полярных ячеек разреза нет - контур обходит полюс
+    bool crossesAntimeridian(const Cell &cell);
+    std::span<const Point> easternPart(const Cell &cell);
+    std::span<const Point> westernPart(const Cell &cell);
+
+    // Ячейки, чей прямоугольник пересекает заданный. Долготы прямоугольника могут быть развёрнуты
+    std::vector<H3Index> cellsInBounds(int resolution, double west, double south, double east, double north);
+
+    // Массивы из сгенерированного файла
+    namespace detail
+    {
+        extern const Cell kCells[];
+        extern const size_t kCellCount;
+        extern const Vertex kVertices[];
+        extern const size_t kVertexCount;
+        extern const uint32_t kRings[];
+        extern const Point kBoundaryPoints[];
+        extern const Point kSplitPoints[];
+    } // namespace detail
+} // namespace H3CoarseGeometry
+
+#endif //H3COARSEGEOMETRY_H
@@ -0,0 +1,97 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3ColorRamp.h"
+
+#include <algorithm>
+#include <cmath>
+
+H3ColorRamp::H3ColorRamp() : m_stops{QColor(Qt::blue), QColor(Qt::green), QColor(Qt::red)}
+{
+    rebuildTable();
+}
+
+void H3ColorRamp::setRange(const double minValue, const double maxValue)
+{
+    m_minValue = minValue;
+    m_maxValue = maxValue;
+}
+
+bool H3ColorRamp::setStops(std::vector<QColor> stops)
+{
+    if (stops.empty())
+        return false;
+
+    m_stops = std::move(stops);
+    rebuildTable();
+    return true;
+}
+
+void H3ColorRamp::setNoDataColor(const QColor& color)
+{
+    m_noDataColor = color;
+    m_table[kSize] = m_noDataColor.rgba();
+}
+
+QColor H3ColorRamp::color(const double value) const
+{
+    if (std::isnan(value))
+        return m_noDataColor;
+
+    // ±Infinity при нулевом диапазоне даёт NaN - такие значения уходят в начало шкалы
+    const double range = m_maxValue - m_minValue;
+    const double normalized = range > 0.0 ? (value - m_minValue) / range : 0.0;
+    return interpolate(normalized > 0.0 ? std::min(normalized, 1.0) : 0.0);
+}
+
+void H3ColorRamp::colors(const std::vector<float>& values, std::vector<QRgb>& colors) const
+{
+    colors.resize(values.size());
+
+    const float range = static_cast<float>(m_maxValue - m_minValue);
+    const float scale = range > 0.0f ? static_cast<float>(kSize - 1) / range : 0.0f;
+    const float minValue = static_cast<float>(m_minValue);
+    const size_t count = values.size();
+    const float* in = values.data();
+    QRgb* out = colors.data();
+
+    // Сначала индексы в таблице шкалы: цикл без ветвлений, компилятор его векторизует.
+    // NaN не равен себе и уходит в последний элемент таблицы. При нулевом диапазоне ±Infinity даёт
+    // inf * 0 = NaN: сравнение с нулём ложно, и такая позиция становится 0 до приведения к целому
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float scaled = (in[i] - minValue) * scale;
+        const float position = scaled > 0.0f ? std::min(scaled, static_cast<float>(kSize - 1)) : 0.0f;
+        out[i] = in[i] == in[i] ? static_cast<QRgb>(position) : static_cast<QRgb>(kSize);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        out[i] = m_table[out[i]];
+}
+
+QColor H3ColorRamp::interpolate(const double normalized) const
+{
+    if (m_stops.size() == 1)
+        return m_stops.front();
+
+    // Линейная интерполяция между соседними опорными цветами
+    const double position = normalized * static_cast<double>(m_stops.size() - 1);
+    const size_t segment = std::min(static_cast<size_t>(position), m_stops.size() - 2);
+    const float t = static_cast<float>(position - static_cast<double>(segment));
+
+    const QColor& from = m_stops[segment];
+    const QColor& to = m_stops[segment + 1];
+
+    QColor color;
+    color.setRgbF(from.redF() + (to.redF() - from.redF()) * t, from.greenF() + (to.greenF() - from.greenF()) * t,
+                  from.blueF() + (to.blueF() - from.blueF()) * t, from.alphaF() + (to.alphaF() - from.alphaF()) * t);
+    return color;
+}
+
+void H3ColorRamp::rebuildTable()
+{
+    for (int i = 0; i < kSize; ++i)
+        m_table[i] = interpolate(static_cast<double>(i) / (kSize - 1)).rgba();
+    m_table[kSize] = m_noDataColor.rgba();
+}
@@ -0,0 +1,48 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3COLORRAMP_H
+#define H3COLORRAMP_H
+
+#include <QColor>
+
+#include <array>
+#include <vector>
+
+// Цветовая шкала значений: опорные цвета равномерно от minValue до maxValue и таблица на kSize цветов для
+// пакетной раскраски. Обычное значение, не QObject: генераторы тайлов получают копию и читают её из пула потоков
+class H3ColorRamp {
+public:
+    static constexpr int kSize = 256;
+
+    H3ColorRamp();
+
+    double minValue() const { return m_minValue; }
+    double maxValue() const { return m_maxValue; }
+    void setRange(double minValue, double maxValue);
+
+    const std::vector<QColor> &stops() const { return m_stops; }
+    // Пустой набор не принимается
+    bool setStops(std::vector<QColor> stops);
+
+    QColor noDataColor() const { return m_noDataColor; }
+    void setNoDataColor(const QColor &color);
+
+    // NaN даёт noDataColor, значения вне диапазона прижимаются к краям шкалы
+    QColor color(double value) const;
+    // Цвета для массива значений за один проход через таблицу шкалы
+    void colors(const std::vector<float> &values, std::vector<QRgb> &colors) const;
+
+private:
+    QColor interpolate(double normalized) const;
+    void rebuildTable();
+
+    double m_minValue{0.0};
+    double m_maxValue{1.0};
+    std::vector<QColor> m_stops;
+    QColor m_noDataColor{Qt::transparent};
+    std::array<QRgb, kSize + 1> m_table{}; // Последний элемент - цвет пропуска
+};
+
+#endif //H3COLORRAMP_H
@@ -0,0 +1,311 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3FLATMAP_H
+#define H3FLATMAP_H
+
+#include <h3api.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define H3_FLAT_MAP_SSE2 1
+#endif
+
+// Хеш-таблица с открытой адресацией для ключей H3Index (по мотивам SwissTable).
+// Записи лежат одним массивом без аллокаций на элемент. На каждую запись приходится байт метаданных:
+// пусто, удалено или 7 бит хеша. Поиск сравнивает сразу группу из 16 байт метаданных (SSE2 или
+// скалярно) и только при совпадении читает ключ
+template <typename V>
+class H3FlatMap {
+public:
+    using key_type = H3Index;
+    using mapped_type = V;
+    using value_type = std::pair<H3Index, V>;
+
+    static constexpr size_t kGroupWidth = 16;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = H3FlatMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+        using reference = std::conditional_t<Const, const value_type &, value_type &>;
+        using MapPointer = std::conditional_t<Const, const H3FlatMap *, H3FlatMap *>;
+
+        Iterator() = default;
+        Iterator(MapPointer map, size_t slot) : m_map(map), m_slot(slot) { skipEmpty(); }
+        operator Iterator<true>() const { return {m_map, m_slot}; }
+
+        reference operator*() const { return m_map->m_slots[m_slot]; }
+        pointer operator->() const { return &m_map->m_slots[m_slot]; }
+
+        Iterator &operator++()
+        {
+            ++m_slot;
+            skipEmpty();
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const Iterator &other) const { return m_slot == other.m_slot; }
+        bool operator!=(const Iterator &other) const { return m_slot != other.m_slot; }
+
+    private:
+        friend class H3FlatMap;
+
+        // Слот заведомо занят или это end(): пропуск пустых не нужен
+        Iterator(MapPointer map, size_t slot, bool) : m_map(map), m_slot(slot) {}
+
+        void skipEmpty()
+        {
+            while (m_slot < m_map->capacity() && !isFull(m_map->m_ctrl[m_slot]))
+                ++m_slot;
+        }
+
+        MapPointer m_map{nullptr};
+        size_t m_slot{0};
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    H3FlatMap() = default;
+    H3FlatMap(const H3FlatMap &) = default;
+    H3FlatMap &operator=(const H3FlatMap &) = default;
+
+    // Перемещённая таблица остаётся пустой и пригодной к использованию
+    H3FlatMap(H3FlatMap &&other) noexcept :
+        m_ctrl(std::move(other.m_ctrl)), m_slots(std::move(other.m_slots)), m_size(std::exchange(other.m_size, 0)),
+        m_deleted(std::exchange(other.m_deleted, 0))
+    {
+        other.m_ctrl.clear();
+        other.m_slots.clear();
+    }
+
+    H3FlatMap &operator=(H3FlatMap &&other) noexcept
+    {
+        if (this != &other)
+        {
+            m_ctrl = std::move(other.m_ctrl);
+            m_slots = std::move(other.m_slots);
+            m_size = std::exchange(other.m_size, 0);
+            m_deleted = std::exchange(other.m_deleted, 0);
+            other.m_ctrl.clear();
+            other.m_slots.clear();
+        }
+        return *this;
+    }
+
+    // Смешивание под раскладку H3: разрешение в битах 52-55, а младшие 3 * (15 - res) бит у ячейки
+    // заняты неиспользуемыми цифрами (все единицы). Сдвигаем их, чтобы в хеш шли только значащие биты,
+    // затем фибоначчиево умножение и свёртка старшей половины в младшую (младшие 7 бит - метка)
+    static uint64_t hash(const H3Index index)
+    {
+        const unsigned resolution = static_cast<unsigned>((index >> 52) & 0xF);
+        const uint64_t h = (index >> (3 * (15 - resolution))) * 0x9e3779b97f4a7c15ULL;
+        return h ^ (h >> 32);
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_slots.size(); }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, capacity()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, capacity()}; }
+
+    void clear()
+    {
+        if (m_size == 0 && m_deleted == 0)
+            return;
+        std::memset(m_ctrl.data(), kEmpty, m_ctrl.size());
+        for (value_type &slot : m_slots)
+            slot = value_type();
+        m_size = 0;
+        m_deleted = 0;
+    }
+
+    void reserve(const size_t count)
+    {
+        // Заполнение не выше 7/8
+        const size_t needed = std::bit_ceil(std::max(kGroupWidth, count + count / 7 + 1));
+        if (needed > capacity())
+            rehash(needed);
+    }
+
+    iterator find(const H3Index key) { return iterator(this, findSlot(key), true); }
+    const_iterator find(const H3Index key) const { return const_iterator(this, findSlot(key), true); }
+    bool contains(const H3Index key) const { return findSlot(key) != capacity(); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const H3Index key, Args &&...args)
+    {
+        if (const size_t slot = findSlot(key); slot != capacity())
+            return {iterator(this, slot, true), false};
+
+        const size_t slot = insertSlot(key);
+        m_slots[slot].second = V(std::forward<Args>(args)...);
+        return {iterator(this, slot, true), true};
+    }
+
+    V &operator[](const H3Index key) { return try_emplace(key).first->second; }
+
+    size_t erase(const H3Index key)
+    {
+        const size_t slot = findSlot(key);
+        if (slot == capacity())
+            return 0;
+
+        setCtrl(slot, kDeleted);
+        m_slots[slot] = value_type();
+        --m_size;
+        ++m_deleted;
+        return 1;
+    }
+
+private:
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+
+    static bool isFull(const int8_t ctrl) { return ctrl >= 0; }
+
+    // Маски байтов группы: совпавших с меткой и пустых. Группа читается один раз
+    static void matchGroup(const int8_t *group, const int8_t tag, uint32_t &hits, uint32_t &empty)
+    {
+#ifdef H3_FLAT_MAP_SSE2
+        const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+        hits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag))));
+        empty = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(kEmpty))));
+#else
+        hits = 0;
+        empty = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i)
+        {
+            hits |= static_cast<uint32_t>(group[i] == tag) << i;
+            empty |= static_cast<uint32_t>(group[i] == kEmpty) << i;
+        }
+#endif
+    }
+
+    // Маска пустых или удалённых байтов группы (старший бит установлен)
+    static uint32_t matchFree(const int8_t *group)
+    {
+#ifdef H3_FLAT_MAP_SSE2
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i)
+            mask |= static_cast<uint32_t>(group[i] < 0) << i;
+        return mask;
+#endif
+    }
+
+    size_t findSlot(const H3Index key) const
+    {
+        if (m_size == 0)
+            return capacity();
+
+        const uint64_t h = hash(key);
+        const auto tag = static_cast<int8_t>(h & 0x7F);
+        const size_t mask = capacity() - 1;
+
+        // Квадратичное пробирование по группам; пустой байт в группе - ключа в таблице нет
+        size_t position = (h >> 7) & mask;
+        for (size_t step = kGroupWidth;; step += kGroupWidth)
+        {
+            uint32_t hits;
+            uint32_t empty;
+            matchGroup(m_ctrl.data() + position, tag, hits, empty);
+            for (; hits; hits &= hits - 1)
+            {
+                const size_t slot = (position + std::countr_zero(hits)) & mask;
+                if (m_slots[slot].first == key)
+                    return slot;
+            }
+            if (empty)
+                return capacity();
+            position = (position + step) & mask;
+        }
+    }
+
+    size_t insertSlot(const H3Index key)
+    {
+        if (capacity() == 0 || (m_size + m_deleted + 1) * 8 > capacity() * 7)
+        {
+            // Много удалённых - хватит перестроить на месте
+            rehash(m_size * 2 + 2 > capacity() ? std::max(kGroupWidth, capacity() * 2) : capacity());
+        }
+
+        const uint64_t h = hash(key);
+        const size_t mask = capacity() - 1;
+        size_t position = (h >> 7) & mask;
+        for (size_t step = kGroupWidth;; step += kGroupWidth)
+        {
+            if (const uint32_t free = matchFree(m_ctrl.data() + position))
+            {
+                const size_t slot = (position + std::countr_zero(free)) & mask;
+                if (m_ctrl[slot] == kDeleted)
+                    --m_deleted;
+                setCtrl(slot, static_cast<int8_t>(h & 0x7F));
+                m_slots[slot].first = key;
+                ++m_size;
+                return slot;
+            }
+            position = (position + step) & mask;
+        }
+    }
+
+    // Первые kGroupWidth байт продублированы в хвосте: группу можно читать с любой позиции без переноса
+    void setCtrl(const size_t slot, const int8_t value)
+    {
+        m_ctrl[slot] = value;
+        if (slot < kGroupWidth)
+            m_ctrl[capacity() + slot] = value;
+    }
+
+    void rehash(const size_t newCapacity)
+    {
+        std::vector<int8_t> oldCtrl = std::move(m_ctrl);
+        std::vector<value_type> oldSlots = std::move(m_slots);
+
+        m_ctrl.assign(newCapacity + kGroupWidth, kEmpty);
+        m_slots.clear();
+        m_slots.resize(newCapacity);
+        m_size = 0;
+        m_deleted = 0;
+
+        for (size_t i = 0; i < oldSlots.size(); ++i)
+        {
+            if (isFull(oldCtrl[i]))
+            {
+                const size_t slot = insertSlot(oldSlots[i].first);
+                m_slots[slot].second = std::move(oldSlots[i].second);
+            }
+        }
+    }
+
+    std::vector<int8_t> m_ctrl;
+    std::vector<value_type> m_slots;
+    size_t m_size{0};
+    size_t m_deleted{0};
+};
+
+#endif //H3FLATMAP_H
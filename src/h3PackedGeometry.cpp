@@ -0,0 +1,179 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3PackedGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "tileMath.h"
+
+namespace
+{
+    struct Placement {
+        uint64_t tile; // y в старшей половине, x в младшей: сортировка идёт по строкам тайлов
+        uint32_t id;
+
+        bool operator<(const Placement& other) const { return tile < other.tile; }
+    };
+
+    // Ближайшая к reference копия x через антимеридиан
+    double unwrap(const double x, const double reference)
+    {
+        if (x - reference > 0.5)
+            return x - 1.0;
+        if (x - reference < -0.5)
+            return x + 1.0;
+        return x;
+    }
+
+    uint64_t tileKey(const double x, const double y, const int zoom)
+    {
+        const int64_t tiles = int64_t(1) << zoom;
+        const int64_t tileX = ((static_cast<int64_t>(std::floor(x * tiles)) % tiles) + tiles) % tiles;
+        const int64_t tileY = std::clamp<int64_t>(static_cast<int64_t>(std::floor(y * tiles)), 0, tiles - 1);
+        return (static_cast<uint64_t>(tileY) << 32) | static_cast<uint64_t>(tileX);
+    }
+} // namespace
+
+double H3PackedGeometry::worldX(const double longitude) { return TileMath::lngToTileX(longitude, 0); }
+
+double H3PackedGeometry::worldY(const double latitude) { return TileMath::latToTileY(latitude, 0); }
+
+void H3PackedGeometry::build(const H3TopologyMesh& mesh, const int tileZoom)
+{
+    clear();
+    m_tileZoom = std::clamp(tileZoom, 0, 30);
+
+    const std::vector<H3TopologyMesh::Vertex>& vertices = mesh.vertices();
+    std::vector<double> xs(vertices.size());
+    std::vector<double> ys(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        xs[i] = worldX(vertices[i].longitude);
+        ys[i] = worldY(vertices[i].latitude);
+    }
+
+    // Раскладка ячеек и рёбер по тайлам
+    std::vector<Placement> cellPlacements;
+    cellPlacements.reserve(mesh.cellCount());
+    for (size_t cell = 0; cell < mesh.cellCount(); ++cell)
+    {
+        const std::span<const uint32_t> ring = mesh.cellRing(cell);
+        if (ring.empty())
+            continue;
+
+        double sumX = 0.0;
+        double sumY = 0.0;
+        for (const uint32_t vertex : ring)
+        {
+            sumX += unwrap(xs[vertex], xs[ring.front()]);
+            sumY += ys[vertex];
+        }
+        cellPlacements.push_back(
+            {tileKey(sumX / ring.size(), sumY / ring.size(), m_tileZoom), static_cast<uint32_t>(cell)});
+    }
+
+    const std::vector<H3TopologyMesh::Edge>& edges = mesh.edges();
+    std::vector<Placement> edgePlacements;
+    edgePlacements.reserve(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        const double x = (xs[edges[i].first] + unwrap(xs[edges[i].second], xs[edges[i].first])) / 2.0;
+        const double y = (ys[edges[i].first] + ys[edges[i].second]) / 2.0;
+        edgePlacements.push_back({tileKey(x, y, m_tileZoom), static_cast<uint32_t>(i)});
+    }
+
+    std::sort(cellPlacements.begin(), cellPlacements.end());
+    std::sort(edgePlacements.begin(), edgePlacements.end());
+
+    // Номер вершины внутри текущего тайла; stamp отмечает, к какому тайлу он относится. Кольцо через
+    // антимеридиан разворачивается вокруг своей первой вершины, поэтому одна вершина может попасть в тайл
+    // с двумя разными x - тогда у неё две локальные копии
+    constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> localIndex(vertices.size());
+    std::vector<uint32_t> stamp(vertices.size(), kNone);
+    std::vector<float> localX(vertices.size());
+
+    const double tiles = static_cast<double>(int64_t(1) << m_tileZoom);
+    auto cellIt = cellPlacements.begin();
+    auto edgeIt = edgePlacements.begin();
+    while (cellIt != cellPlacements.end() || edgeIt != edgePlacements.end())
+    {
+        const uint64_t key = std::min(cellIt != cellPlacements.end() ? cellIt->tile : ~uint64_t(0),
+                                      edgeIt != edgePlacements.end() ? edgeIt->tile : ~uint64_t(0));
+        const auto tileId = static_cast<uint32_t>(m_tiles.size());
+
+        Tile& tile = m_tiles.emplace_back();
+        tile.z = m_tileZoom;
+        tile.x = static_cast<int>(key & 0xFFFFFFFFu);
+        tile.y = static_cast<int>(key >> 32);
+        tile.ringOffsets.push_back(0);
+
+        // x - уже развёрнутая координата в долях мира
+        const auto local = [&](const uint32_t vertex, const double x)
+        {
+            const auto position = static_cast<float>(x * tiles - tile.x);
+            if (stamp[vertex] != tileId || localX[vertex] != position)
+            {
+                stamp[vertex] = tileId;
+                localX[vertex] = position;
+                localIndex[vertex] = static_cast<uint32_t>(tile.vertexCount());
+                tile.positions.push_back(position);
+                tile.positions.push_back(static_cast<float>(ys[vertex] * tiles - tile.y));
+            }
+            return localIndex[vertex];
+        };
+
+        for (; cellIt != cellPlacements.end() && cellIt->tile == key; ++cellIt)
+        {
+            const std::span<const uint32_t> ring = mesh.cellRing(cellIt->id);
+            double sumX = 0.0;
+            for (const uint32_t vertex : ring)
+                sumX += unwrap(xs[vertex], xs[ring.front()]);
+            // Сдвиг на целое число миров, после которого центр кольца лежит в [0, 1), как у tileKey
+            const double shift = -std::floor(sumX / ring.size());
+
+            for (const uint32_t vertex : ring)
+                tile.rings.push_back(local(vertex, unwrap(xs[vertex], xs[ring.front()]) + shift));
+            tile.ringOffsets.push_back(static_cast<uint32_t>(tile.rings.size()));
+            tile.cells.push_back(cellIt->id);
+        }
+        for (; edgeIt != edgePlacements.end() && edgeIt->tile == key; ++edgeIt)
+        {
+            const H3TopologyMesh::Edge& edge = edges[edgeIt->id];
+            const double first = xs[edge.first];
+            const double second = unwrap(xs[edge.second], first);
+            const double shift = -std::floor((first + second) / 2.0);
+            tile.edges.push_back(local(edge.first, first + shift));
+            tile.edges.push_back(local(edge.second, second + shift));
+        }
+    }
+}
+
+void H3PackedGeometry::clear()
+{
+    m_tiles.clear();
+}
+
+size_t H3PackedGeometry::memoryBytes() const
+{
+    size_t bytes = m_tiles.capacity() * sizeof(Tile);
+    for (const Tile& tile : m_tiles)
+    {
+        bytes += tile.positions.capacity() * sizeof(float) +
+            (tile.rings.capacity() + tile.ringOffsets.capacity() + tile.cells.capacity() + tile.edges.capacity()) *
+                sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+QTransform H3PackedGeometry::tileTransform(const Tile& tile, const double cameraX, const double cameraY,
+                                           const double pixelsPerWorld)
+{
+    const double scale = pixelsPerWorld / static_cast<double>(int64_t(1) << tile.z);
+    return QTransform(scale, 0.0, 0.0, scale, (tile.x * scale) - cameraX * pixelsPerWorld,
+                      (tile.y * scale) - cameraY * pixelsPerWorld);
+}
@@ -0,0 +1,57 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3PACKEDGEOMETRY_H
+#define H3PACKEDGEOMETRY_H
+
+#include <QTransform>
+
+#include <cstdint>
+#include <vector>
+
+#include "h3TopologyMesh.h"
+
+// Геометрия ячеек в виде, готовом для вершинного буфера: float32 смещения Web-Mercator от левого верхнего
+// угла тайла (1.0 - ширина тайла). Относительно тайла точности float хватает на любом зуме, а перепроекция
+// при панорамировании и масштабе - одна аффинная матрица на тайл вместо пересчёта QGeoCoordinate
+class H3PackedGeometry {
+public:
+    struct Tile {
+        int z{0};
+        int x{0};
+        int y{0};
+        std::vector<float> positions;      // x, y парами
+        std::vector<uint32_t> rings;       // Кольца ячеек: номера вершин в positions
+        std::vector<uint32_t> ringOffsets; // Начало кольца i, последний элемент - размер rings
+        std::vector<uint32_t> cells;       // Номер ячейки в mesh (строка модели) для кольца i
+        std::vector<uint32_t> edges;       // Уникальные рёбра парами вершин (GL_LINES)
+
+        size_t vertexCount() const { return positions.size() / 2; }
+        size_t ringCount() const { return cells.size(); }
+    };
+
+    // Ячейка попадает в тайл своего центра, ребро - в тайл своей середины. Вершины на границе тайлов
+    // повторяются в каждом из них, внутри тайла - один раз
+    void build(const H3TopologyMesh &mesh, int tileZoom);
+    void clear();
+
+    int tileZoom() const { return m_tileZoom; }
+    const std::vector<Tile> &tiles() const { return m_tiles; }
+
+    size_t memoryBytes() const;
+
+    // Из координат тайла в пиксели экрана. (cameraX, cameraY) - левый верхний угол экрана в долях мира
+    // Web-Mercator, pixelsPerWorld - размер мира в пикселях (tileSize * 2^zoom)
+    static QTransform tileTransform(const Tile &tile, double cameraX, double cameraY, double pixelsPerWorld);
+
+    // Доли мира Web-Mercator: x от -180 до 180 градусов, y от севера к югу
+    static double worldX(double longitude);
+    static double worldY(double latitude);
+
+private:
+    int m_tileZoom{0};
+    std::vector<Tile> m_tiles;
+};
+
+#endif //H3PACKEDGEOMETRY_H
@@ -0,0 +1,227 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3SortedIndex.h"
+
+#include <algorithm>
+
+#include "h3TaskScheduler.h"
+
+namespace
+{
+    constexpr int kResolutionShift = 52;
+    constexpr H3Index kResolutionMask = H3Index(0xF) << kResolutionShift;
+    constexpr size_t kParallelThreshold = 1 << 16;
+    constexpr int kRadixBits = 8;
+    constexpr size_t kRadixSize = 1 << kRadixBits;
+
+    int resolutionOf(const H3Index index) { return static_cast<int>((index >> kResolutionShift) & 0xF); }
+
+    H3Index withResolution(const H3Index index, const int resolution)
+    {
+        return (index & ~kResolutionMask) | (H3Index(resolution) << kResolutionShift);
+    }
+
+    // Биты цифр с номерами больше resolution
+    H3Index digitsBelow(const int resolution)
+    {
+        return (H3Index(1) << (3 * (H3SortedIndex::kMaxResolution - resolution))) - 1;
+    }
+} // namespace
+
+void H3SortedIndex::build(std::vector<Entry> entries)
+{
+    std::erase_if(entries, [](const Entry& entry) { return !isValidCell(entry.index); });
+
+    // Поле разрешения стоит выше базовой ячейки и цифр: общий порядок сразу группирует ячейки по разрешениям
+    radixSort(entries);
+
+    clear();
+    auto first = entries.begin();
+    while (first != entries.end())
+    {
+        const int resolution = resolutionOf(first->index);
+        const auto last =
+            std::find_if(first, entries.end(), [resolution](const Entry& entry)
+                         { return resolutionOf(entry.index) != resolution; });
+        m_levels[resolution].assign(first, last);
+        first = last;
+    }
+}
+
+void H3SortedIndex::clear()
+{
+    for (std::vector<Entry>& level : m_levels)
+        level.clear();
+}
+
+size_t H3SortedIndex::size() const
+{
+    size_t total = 0;
+    for (const std::vector<Entry>& level : m_levels)
+        total += level.size();
+    return total;
+}
+
+H3SortedIndex::Range H3SortedIndex::descendants(const H3Index parent, const int resolution) const
+{
+    if (resolution < 0 || resolution > kMaxResolution || resolution < resolutionOf(parent))
+        return {0, 0};
+
+    const std::vector<Entry>& level = m_levels[resolution];
+    const auto less = [](const Entry& entry, const H3Index index) { return entry.index < index; };
+    const auto greater = [](const H3Index index, const Entry& entry) { return index < entry.index; };
+
+    const auto first = std::lower_bound(level.begin(), level.end(), firstDescendant(parent, resolution), less);
+    const auto last = std::upper_bound(first, level.end(), lastDescendant(parent, resolution), greater);
+    return {static_cast<size_t>(first - level.begin()), static_cast<size_t>(last - level.begin())};
+}
+
+double H3SortedIndex::sumDescendants(const H3Index parent, const int resolution) const
+{
+    const auto [first, last] = descendants(parent, resolution);
+    const std::vector<Entry>& level = m_levels[std::clamp(resolution, 0, kMaxResolution)];
+
+    double sum = 0.0;
+    for (size_t i = first; i < last; ++i)
+        sum += level[i].value;
+    return sum;
+}
+
+std::vector<H3SortedIndex::Entry> H3SortedIndex::rollup(const int childResolution, const int parentResolution) const
+{
+    std::vector<Entry> result;
+    if (childResolution < 0 || childResolution > kMaxResolution || parentResolution < 0 ||
+        parentResolution > childResolution)
+        return result;
+
+    // Потомки одного родителя идут подряд, поэтому достаточно сравнивать с последним родителем
+    for (const Entry& entry : m_levels[childResolution])
+    {
+        const H3Index parent = parentOf(entry.index, parentResolution);
+        if (!result.empty() && result.back().index == parent)
+            result.back().value += entry.value;
+        else
+            result.push_back({parent, entry.value});
+    }
+    return result;
+}
+
+std::vector<H3SortedIndex::Range> H3SortedIndex::intersect(const std::vector<H3Index>& cover, const int resolution) const
+{
+    std::vector<Range> ranges;
+    ranges.reserve(cover.size());
+    for (const H3Index cell : cover)
+    {
+        const Range range = descendants(cell, resolution);
+        if (range.first < range.second)
+            ranges.push_back(range);
+    }
+
+    std::sort(ranges.begin(), ranges.end());
+
+    // Ячейки покрытия разных разрешений могут вкладываться друг в друга
+    std::vector<Range> merged;
+    for (const Range& range : ranges)
+    {
+        if (!merged.empty() && range.first <= merged.back().second)
+            merged.back().second = std::max(merged.back().second, range.second);
+        else
+            merged.push_back(range);
+    }
+    return merged;
+}
+
+H3Index H3SortedIndex::parentOf(const H3Index index, const int parentResolution)
+{
+    return withResolution(index, parentResolution) | digitsBelow(parentResolution);
+}
+
+H3Index H3SortedIndex::firstDescendant(const H3Index parent, const int resolution)
+{
+    // Цифры от разрешения родителя до resolution обнуляются, ниже остаются семёрки
+    const H3Index digits = digitsBelow(resolutionOf(parent)) & ~digitsBelow(resolution);
+    return withResolution(parent, resolution) & ~digits;
+}
+
+H3Index H3SortedIndex::lastDescendant(const H3Index parent, const int resolution)
+{
+    return withResolution(parent, resolution) | digitsBelow(resolutionOf(parent));
+}
+
+void H3SortedIndex::radixSort(std::vector<Entry>& entries)
+{
+    const size_t count = entries.size();
+    if (count < 2)
+        return;
+
+    // Байты, одинаковые у всех ключей, на порядок не влияют - их проходы пропускаем.
+    // У ячеек одного разрешения это режим, разрешение и хвост из неиспользуемых цифр
+    H3Index common = ~H3Index(0);
+    H3Index any = 0;
+    for (const Entry& entry : entries)
+    {
+        common &= entry.index;
+        any |= entry.index;
+    }
+    const H3Index varying = common ^ any;
+
+    H3TaskScheduler& scheduler = H3TaskScheduler::instance();
+    const int chunks = count < kParallelThreshold ? 1 : scheduler.threadCount();
+    const size_t chunkSize = (count + chunks - 1) / chunks;
+
+    std::vector<std::array<size_t, kRadixSize>> histograms(chunks);
+    std::vector<Entry> buffer(count);
+
+    // Перестройка индекса - фоновое обслуживание: части отдаются потокам этого класса, вызывающий поток
+    // считает вместе с ними, поэтому сортировка не стоит, даже если класс занят
+    const auto forEachChunk = [&](const std::function<void(int)>& function)
+    {
+        if (chunks == 1)
+            function(0);
+        else
+            scheduler.parallelFor(TaskPriority::Maintenance, chunks, function);
+    };
+
+    for (int shift = 0; shift < 64; shift += kRadixBits)
+    {
+        if (((varying >> shift) & (kRadixSize - 1)) == 0)
+            continue;
+
+        // Гистограммы по частям массива параллельно
+        forEachChunk(
+            [&](const int chunk)
+            {
+                std::array<size_t, kRadixSize>& histogram = histograms[chunk];
+                histogram.fill(0);
+                const size_t end = std::min(count, (chunk + 1) * chunkSize);
+                for (size_t i = chunk * chunkSize; i < end; ++i)
+                    ++histogram[(entries[i].index >> shift) & (kRadixSize - 1)];
+            });
+
+        // Смещения: по значению байта, внутри значения - по порядку частей, так сортировка устойчива
+        size_t offset = 0;
+        for (size_t digit = 0; digit < kRadixSize; ++digit)
+        {
+            for (int chunk = 0; chunk < chunks; ++chunk)
+            {
+                const size_t digitCount = histograms[chunk][digit];
+                histograms[chunk][digit] = offset;
+                offset += digitCount;
+            }
+        }
+
+        // Каждая часть пишет в свои непересекающиеся позиции
+        forEachChunk(
+            [&](const int chunk)
+            {
+                std::array<size_t, kRadixSize>& positions = histograms[chunk];
+                const size_t end = std::min(count, (chunk + 1) * chunkSize);
+                for (size_t i = chunk * chunkSize; i < end; ++i)
+                    buffer[positions[(entries[i].index >> shift) & (kRadixSize - 1)]++] = entries[i];
+            });
+
+        entries.swap(buffer);
+    }
+}
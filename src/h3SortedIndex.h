@@ -0,0 +1,59 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3SORTEDINDEX_H
+#define H3SORTEDINDEX_H
+
+#include <h3api.h>
+
+#include <array>
+#include <utility>
+#include <vector>
+
+// Отсортированные массивы ячеек по разрешениям. На фиксированном разрешении все потомки ячейки
+// занимают непрерывный диапазон в числовом порядке H3, поэтому выборка "всё под родителем" - два
+// бинарных поиска, а свёртка к родителям - один линейный проход
+class H3SortedIndex {
+public:
+    static constexpr int kMaxResolution = 15;
+
+    struct Entry {
+        H3Index index;
+        double value;
+    };
+
+    // Полуинтервал [first, last) в массиве разрешения
+    using Range = std::pair<size_t, size_t>;
+
+    // Сборка с нуля: раскладка по разрешениям и параллельная поразрядная сортировка
+    void build(std::vector<Entry> entries);
+    void clear();
+
+    size_t size() const;
+    const std::vector<Entry> &cells(int resolution) const { return m_levels[resolution]; }
+
+    // Потомки parent на разрешении resolution (или сама ячейка, если разрешения совпадают)
+    Range descendants(H3Index parent, int resolution) const;
+    double sumDescendants(H3Index parent, int resolution) const;
+
+    // Суммы значений ячеек childResolution по родителям parentResolution, по возрастанию индекса
+    std::vector<Entry> rollup(int childResolution, int parentResolution) const;
+
+    // Ячейки resolution внутри покрытия viewport: ячейки покрытия любого разрешения не мельче resolution.
+    // Диапазоны отсортированы и не пересекаются
+    std::vector<Range> intersect(const std::vector<H3Index> &cover, int resolution) const;
+
+    // Предок без обращения к H3: поле разрешения и цифры ниже него заменяются на 7
+    static H3Index parentOf(H3Index index, int parentResolution);
+    // Границы числового диапазона потомков parent на разрешении resolution
+    static H3Index firstDescendant(H3Index parent, int resolution);
+    static H3Index lastDescendant(H3Index parent, int resolution);
+
+    static void radixSort(std::vector<Entry> &entries);
+
+private:
+    std::array<std::vector<Entry>, kMaxResolution + 1> m_levels;
+};
+
+#endif //H3SORTEDINDEX_H
@@ -0,0 +1,313 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3TaskScheduler.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Поток-владелец очередей: задачи из рабочего потока ставятся в его же очередь
+    thread_local const H3TaskScheduler* tScheduler = nullptr;
+    thread_local int tWorker = -1;
+
+    uint64_t elapsedNs(const std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count();
+    }
+} // namespace
+
+H3TaskScheduler::H3TaskScheduler(int threadCount)
+{
+    threadCount = std::max(1, threadCount);
+
+    // Видимая область может занять все потоки, фоновые классы - не больше половины, обслуживание - один
+    const int half = std::max(1, threadCount / 2);
+    m_classes[static_cast<int>(TaskPriority::Interactive)].limit = threadCount;
+    m_classes[static_cast<int>(TaskPriority::Prefetch)].limit = half;
+    m_classes[static_cast<int>(TaskPriority::Ingest)].limit = half;
+    m_classes[static_cast<int>(TaskPriority::Maintenance)].limit = 1;
+
+    m_workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < threadCount; ++i)
+        m_workers[i]->thread = std::thread(&H3TaskScheduler::workerLoop, this, i);
+}
+
+H3TaskScheduler::~H3TaskScheduler()
+{
+    waitForDone();
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (const std::unique_ptr<Worker>& worker : m_workers)
+        worker->thread.join();
+}
+
+H3TaskScheduler& H3TaskScheduler::instance()
+{
+    static H3TaskScheduler scheduler;
+    return scheduler;
+}
+
+const char* H3TaskScheduler::priorityName(const TaskPriority priority)
+{
+    switch (priority)
+    {
+    case TaskPriority::Interactive:
+        return "interactive";
+    case TaskPriority::Prefetch:
+        return "prefetch";
+    case TaskPriority::Ingest:
+        return "ingest";
+    case TaskPriority::Maintenance:
+        return "maintenance";
+    case TaskPriority::Count:
+        break;
+    }
+    return "unknown";
+}
+
+int H3TaskScheduler::concurrencyLimit(const TaskPriority priority) const
+{
+    return m_classes[static_cast<int>(priority)].limit.load();
+}
+
+void H3TaskScheduler::setConcurrencyLimit(const TaskPriority priority, const int limit)
+{
+    m_classes[static_cast<int>(priority)].limit = std::clamp(limit, 1, threadCount());
+    {
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+}
+
+CancellationToken H3TaskScheduler::submit(const TaskPriority priority, Task task, CancellationToken token)
+{
+    const int index = static_cast<int>(priority);
+    ClassState& state = m_classes[index];
+
+    const int worker = tScheduler == this
+        ? tWorker
+        : static_cast<int>(m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size());
+
+    // Счётчики растут до постановки, чтобы извлечение не увело их в минус
+    m_outstanding.fetch_add(1);
+    state.queued.fetch_add(1);
+    {
+        std::lock_guard lock(m_workers[worker]->mutex);
+        m_workers[worker]->queues[index].push_back(
+            {std::move(task), token, state.epoch.load(), std::chrono::steady_clock::now()});
+    }
+
+    // Под мьютексом сна: поток, проверивший hasRunnable() до постановки, ещё не успел уснуть
+    {
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+    return token;
+}
+
+void H3TaskScheduler::parallelFor(const TaskPriority priority, const int count, const std::function<void(int)>& body)
+{
+    if (count <= 0)
+        return;
+
+    // Помощники могут стартовать после возврата: им нужна своя копия состояния, но тело они уже не вызовут
+    struct State {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        int count{0};
+        std::function<void(int)> body;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->body = body;
+
+    const auto work = [](State& shared)
+    {
+        for (int i = shared.next.fetch_add(1); i < shared.count; i = shared.next.fetch_add(1))
+        {
+            shared.body(i);
+            if (shared.done.fetch_add(1) + 1 == shared.count)
+            {
+                {
+                    std::lock_guard lock(shared.mutex);
+                }
+                shared.finished.notify_all();
+            }
+        }
+    };
+
+    const int helpers = std::min(count, threadCount()) - 1;
+    for (int i = 0; i < helpers; ++i)
+        submit(priority, [state, work](const CancellationToken&) { work(*state); });
+
+    work(*state);
+
+    std::unique_lock lock(state->mutex);
+    state->finished.wait(lock, [&state, count] { return state->done.load() == count; });
+}
+
+void H3TaskScheduler::cancelQueued(const TaskPriority priority)
+{
+    // Задачи со старой эпохой выбрасываются при извлечении
+    m_classes[static_cast<int>(priority)].epoch.fetch_add(1);
+}
+
+void H3TaskScheduler::waitForDone()
+{
+    std::unique_lock lock(m_sleepMutex);
+    m_idle.wait(lock, [this] { return m_outstanding.load() == 0; });
+}
+
+H3TaskScheduler::ClassStats H3TaskScheduler::stats(const TaskPriority priority) const
+{
+    const ClassState& state = m_classes[static_cast<int>(priority)];
+
+    ClassStats stats;
+    stats.queued = state.queued.load();
+    stats.running = state.running.load();
+    stats.limit = state.limit.load();
+    stats.started = state.started.load();
+    stats.completed = state.completed.load();
+    stats.cancelled = state.cancelled.load();
+    stats.totalWaitNs = state.totalWaitNs.load();
+    stats.maxWaitNs = state.maxWaitNs.load();
+    return stats;
+}
+
+void H3TaskScheduler::workerLoop(const int self)
+{
+    tScheduler = this;
+    tWorker = self;
+
+    for (;;)
+    {
+        Item item;
+        int priority = 0;
+        while (priority < kClassCount && !takeTask(self, priority, item))
+            ++priority;
+
+        if (priority == kClassCount)
+        {
+            std::unique_lock lock(m_sleepMutex);
+            m_wake.wait(lock, [this] { return m_stopping || hasRunnable(); });
+            if (m_stopping && m_outstanding.load() == 0)
+                return;
+            continue;
+        }
+
+        ClassState& state = m_classes[priority];
+        if (item.token.isCancelled() || item.epoch != state.epoch.load())
+        {
+            state.cancelled.fetch_add(1);
+        }
+        else
+        {
+            const uint64_t waitNs = elapsedNs(item.enqueued);
+            state.started.fetch_add(1);
+            state.totalWaitNs.fetch_add(waitNs);
+            uint64_t maxWait = state.maxWaitNs.load();
+            while (waitNs > maxWait && !state.maxWaitNs.compare_exchange_weak(maxWait, waitNs))
+            {
+            }
+
+            item.task(item.token);
+            state.completed.fetch_add(1);
+        }
+
+        // Задача и её захваты освобождаются до того, как waitForDone() увидит завершение
+        item = {};
+        releaseSlot(priority);
+        finishItem();
+    }
+}
+
+bool H3TaskScheduler::takeTask(const int self, const int priority, Item& item)
+{
+    ClassState& state = m_classes[priority];
+    if (state.queued.load() == 0 || !acquireSlot(priority))
+        return false;
+
+    // Своя очередь с конца, затем чужие с начала, начиная со следующего потока
+    const int count = static_cast<int>(m_workers.size());
+    for (int offset = 0; offset < count; ++offset)
+    {
+        Worker& worker = *m_workers[(self + offset) % count];
+        std::lock_guard lock(worker.mutex);
+        std::deque<Item>& queue = worker.queues[priority];
+        if (queue.empty())
+            continue;
+
+        if (offset == 0)
+        {
+            item = std::move(queue.back());
+            queue.pop_back();
+        }
+        else
+        {
+            item = std::move(queue.front());
+            queue.pop_front();
+        }
+        state.queued.fetch_sub(1);
+        return true;
+    }
+
+    releaseSlot(priority);
+    return false;
+}
+
+bool H3TaskScheduler::acquireSlot(const int priority)
+{
+    ClassState& state = m_classes[priority];
+    int running = state.running.load();
+    while (running < state.limit.load())
+    {
+        if (state.running.compare_exchange_weak(running, running + 1))
+            return true;
+    }
+    return false;
+}
+
+void H3TaskScheduler::releaseSlot(const int priority)
+{
+    ClassState& state = m_classes[priority];
+    state.running.fetch_sub(1);
+
+    // Освободившееся место может ждать задача этого класса, упёршаяся в лимит
+    if (state.queued.load() > 0)
+    {
+        {
+            std::lock_guard lock(m_sleepMutex);
+        }
+        m_wake.notify_one();
+    }
+}
+
+bool H3TaskScheduler::hasRunnable() const
+{
+    for (const ClassState& state : m_classes)
+    {
+        if (state.queued.load() > 0 && state.running.load() < state.limit.load())
+            return true;
+    }
+    return false;
+}
+
+void H3TaskScheduler::finishItem()
+{
+    if (m_outstanding.fetch_sub(1) == 1)
+    {
+        {
+            std::lock_guard lock(m_sleepMutex);
+        }
+        m_idle.notify_all();
+    }
+}
@@ -0,0 +1,165 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3TASKSCHEDULER_H
+#define H3TASKSCHEDULER_H
+
+#include <QFuture>
+#include <QPromise>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Классы задач в порядке убывания приоритета
+enum class TaskPriority { Interactive, Prefetch, Ingest, Maintenance, Count };
+
+// Флаг кооперативной отмены: копии разделяют одно состояние, задача сама проверяет его между шагами
+class CancellationToken {
+public:
+    CancellationToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { m_cancelled->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return m_cancelled->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+// Пул потоков с классами приоритета. У каждого рабочего потока свои очереди по классам: задачи,
+// поставленные из рабочего потока, идут в его очередь и берутся с конца (LIFO, горячий кеш),
+// свободный поток забирает чужие с начала. Класс не занимает больше concurrencyLimit потоков,
+// поэтому массовая загрузка не вытесняет задачи видимой области. Отменённые до старта задачи
+// выбрасываются без запуска
+class H3TaskScheduler {
+public:
+    using Task = std::function<void(const CancellationToken &)>;
+
+    struct ClassStats {
+        int queued{0};
+        int running{0};
+        int limit{0};
+        uint64_t started{0};
+        uint64_t completed{0};
+        uint64_t cancelled{0};
+        uint64_t totalWaitNs{0}; // От постановки в очередь до запуска
+        uint64_t maxWaitNs{0};
+    };
+
+    explicit H3TaskScheduler(int threadCount = static_cast<int>(std::thread::hardware_concurrency()));
+    // Дожидается всех поставленных задач
+    ~H3TaskScheduler();
+
+    H3TaskScheduler(const H3TaskScheduler &) = delete;
+    H3TaskScheduler &operator=(const H3TaskScheduler &) = delete;
+
+    // Общий пул приложения: приоритеты работают только между задачами одного пула.
+    // Потоки создаются при первом обращении
+    static H3TaskScheduler &instance();
+
+    static const char *priorityName(TaskPriority priority);
+
+    int threadCount() const { return static_cast<int>(m_workers.size()); }
+
+    int concurrencyLimit(TaskPriority priority) const;
+    void setConcurrencyLimit(TaskPriority priority, int limit);
+
+    CancellationToken submit(TaskPriority priority, Task task, CancellationToken token = {});
+
+    // Результат через QFuture: отмена токена до старта даёт future без результата
+    template <typename Function>
+    QFuture<std::invoke_result_t<Function>> run(TaskPriority priority, Function function,
+                                                CancellationToken token = {});
+
+    // Цикл по [0, count) на потоках класса priority. Вызывающий поток сам берёт индексы и ждёт только уже
+    // начатые другими, поэтому вызов из рабочего потока не блокирует пул и не запускает второй пул
+    void parallelFor(TaskPriority priority, int count, const std::function<void(int)> &body);
+
+    // Отмена ещё не запущенных задач класса; запущенные проверяют свои токены
+    void cancelQueued(TaskPriority priority);
+    void waitForDone();
+
+    ClassStats stats(TaskPriority priority) const;
+
+private:
+    static constexpr int kClassCount = static_cast<int>(TaskPriority::Count);
+
+    struct Item {
+        Task task;
+        CancellationToken token;
+        uint64_t epoch;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Item>, kClassCount> queues;
+        std::thread thread;
+    };
+
+    struct ClassState {
+        std::atomic<int> queued{0};
+        std::atomic<int> running{0};
+        std::atomic<int> limit{1};
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<uint64_t> started{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> cancelled{0};
+        std::atomic<uint64_t> totalWaitNs{0};
+        std::atomic<uint64_t> maxWaitNs{0};
+    };
+
+    void workerLoop(int self);
+    bool takeTask(int self, int priority, Item &item);
+    bool acquireSlot(int priority);
+    void releaseSlot(int priority);
+    bool hasRunnable() const;
+    void finishItem();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::array<ClassState, kClassCount> m_classes;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::atomic<int> m_outstanding{0}; // Поставленные и ещё не завершённые
+    std::atomic<unsigned> m_nextWorker{0};
+    bool m_stopping{false};
+};
+
+template <typename Function>
+QFuture<std::invoke_result_t<Function>> H3TaskScheduler::run(const TaskPriority priority, Function function,
+                                                             CancellationToken token)
+{
+    using Result = std::invoke_result_t<Function>;
+
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    // Выброшенная при отмене задача уничтожает promise - future завершается без результата
+    submit(
+        priority,
+        [promise, function = std::move(function)](const CancellationToken &)
+        {
+            if constexpr (std::is_void_v<Result>)
+                function();
+            else
+                promise->addResult(function());
+            promise->finish();
+        },
+        std::move(token));
+    return future;
+}
+
+#endif //H3TASKSCHEDULER_H
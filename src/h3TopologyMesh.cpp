@@ -0,0 +1,122 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3TopologyMesh.h"
+
+#include <algorithm>
+
+#include "h3CoarseGeometry.h"
+#include "h3FlatMap.h"
+
+namespace
+{
+    constexpr int kMaxCellVertices = 6;
+
+    // Неориентированное ребро: меньший индекс в старшей половине, пары сортируются по первой вершине
+    uint64_t edgeKey(const uint32_t a, const uint32_t b)
+    {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    }
+} // namespace
+
+void H3TopologyMesh::build(const std::vector<H3Index>& cells)
+{
+    clear();
+    m_cellOffsets.reserve(cells.size() + 1);
+    m_cellOffsets.push_back(0);
+    m_cellVertices.reserve(cells.size() * kMaxCellVertices);
+
+    // Почти каждая вершина общая для трёх ячеек: на ячейку приходится около двух уникальных
+    H3FlatMap<uint32_t> vertexIds;
+    vertexIds.reserve(cells.size() * 2 + kMaxCellVertices);
+    m_vertices.reserve(cells.size() * 2 + kMaxCellVertices);
+
+    std::vector<uint64_t> edgeKeys;
+    edgeKeys.reserve(cells.size() * kMaxCellVertices);
+
+    for (const H3Index cell : cells)
+    {
+        // Кольца крупных ячеек и координаты их вершин уже есть в таблицах
+        const H3CoarseGeometry::Cell* coarse = H3CoarseGeometry::find(cell);
+        H3Index vertexes[kMaxCellVertices] = {};
+        const size_t ringStart = m_cellVertices.size();
+        if (coarse)
+        {
+            const std::span<const uint32_t> ring = H3CoarseGeometry::ring(*coarse);
+            for (size_t i = 0; i < ring.size(); ++i)
+                vertexes[i] = H3CoarseGeometry::vertices()[ring[i]].index;
+        }
+        else if (cellToVertexes(cell, vertexes) != E_SUCCESS)
+        {
+            m_cellOffsets.push_back(static_cast<uint32_t>(m_cellVertices.size()));
+            continue;
+        }
+
+        for (int i = 0; i < kMaxCellVertices; ++i)
+        {
+            // У пятиугольника последний элемент пустой
+            if (vertexes[i] == H3_NULL)
+                continue;
+
+            const auto [it, inserted] = vertexIds.try_emplace(vertexes[i], static_cast<uint32_t>(m_vertices.size()));
+            if (inserted)
+            {
+                if (coarse)
+                {
+                    const H3CoarseGeometry::Vertex& vertex =
+                        H3CoarseGeometry::vertices()[H3CoarseGeometry::ring(*coarse)[i]];
+                    m_vertices.push_back({vertex.lat, vertex.lng});
+                }
+                else
+                {
+                    LatLng point;
+                    vertexToLatLng(vertexes[i], &point);
+                    m_vertices.push_back({radsToDegs(point.lat), radsToDegs(point.lng)});
+                }
+            }
+            m_cellVertices.push_back(it->second);
+        }
+
+        const size_t ringSize = m_cellVertices.size() - ringStart;
+        for (size_t i = 0; i < ringSize; ++i)
+        {
+            edgeKeys.push_back(
+                edgeKey(m_cellVertices[ringStart + i], m_cellVertices[ringStart + (i + 1) % ringSize]));
+        }
+        m_cellOffsets.push_back(static_cast<uint32_t>(m_cellVertices.size()));
+    }
+
+    // Общее ребро двух ячеек встречается дважды подряд, ребро границы набора - один раз
+    std::sort(edgeKeys.begin(), edgeKeys.end());
+    m_edges.reserve(edgeKeys.size() / 2 + 1);
+    for (size_t i = 0; i < edgeKeys.size();)
+    {
+        size_t next = i + 1;
+        while (next < edgeKeys.size() && edgeKeys[next] == edgeKeys[i])
+            ++next;
+        m_edges.push_back({static_cast<uint32_t>(edgeKeys[i] >> 32), static_cast<uint32_t>(edgeKeys[i]), next - i == 1});
+        i = next;
+    }
+}
+
+void H3TopologyMesh::clear()
+{
+    m_vertices.clear();
+    m_cellVertices.clear();
+    m_cellOffsets.clear();
+    m_edges.clear();
+}
+
+std::span<const uint32_t> H3TopologyMesh::cellRing(const size_t cell) const
+{
+    if (cell >= cellCount())
+        return {};
+    return {m_cellVertices.data() + m_cellOffsets[cell], m_cellOffsets[cell + 1] - m_cellOffsets[cell]};
+}
+
+size_t H3TopologyMesh::memoryBytes() const
+{
+    return m_vertices.capacity() * sizeof(Vertex) + m_cellVertices.capacity() * sizeof(uint32_t) +
+        m_cellOffsets.capacity() * sizeof(uint32_t) + m_edges.capacity() * sizeof(Edge);
+}
@@ -0,0 +1,50 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3TOPOLOGYMESH_H
+#define H3TOPOLOGYMESH_H
+
+#include <h3api.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Общая топология набора ячеек: соседние шестиугольники делят вершины и рёбра, поэтому вершины
+// хранятся один раз в индексированном буфере, а ячейка - кольцо индексов в нём. Вершины берутся из
+// vertex API H3 (cellToVertexes), без дополнительных точек искажения на рёбрах икосаэдра
+class H3TopologyMesh {
+public:
+    struct Vertex {
+        double latitude;
+        double longitude;
+    };
+
+    struct Edge {
+        uint32_t first;
+        uint32_t second;
+        bool border; // Ребро одной ячейки набора - внешняя граница
+    };
+
+    // Ячейки нумеруются в порядке cells; для невалидных колец нет
+    void build(const std::vector<H3Index> &cells);
+    void clear();
+
+    const std::vector<Vertex> &vertices() const { return m_vertices; }
+    const std::vector<Edge> &edges() const { return m_edges; }
+
+    size_t cellCount() const { return m_cellOffsets.empty() ? 0 : m_cellOffsets.size() - 1; }
+    // Индексы вершин ячейки в порядке обхода, без повтора первой
+    std::span<const uint32_t> cellRing(size_t cell) const;
+
+    size_t memoryBytes() const;
+
+private:
+    std::vector<Vertex> m_vertices;
+    std::vector<uint32_t> m_cellVertices;
+    std::vector<uint32_t> m_cellOffsets; // Начало кольца ячейки i, последний элемент - общий размер
+    std::vector<Edge> m_edges;
+};
+
+#endif //H3TOPOLOGYMESH_H
@@ -0,0 +1,241 @@
+//
+// Created by user on 10/18/26.
+//
+
+// h3-coarse-gen: запускается при сборке и пишет таблицы H3CoarseGeometry для разрешений 0-2.
+// Зависит только от H3, без Qt
+
+#include <h3api.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "h3CoarseGeometry.h"
+
+namespace
+{
+    using H3CoarseGeometry::Cell;
+    using H3CoarseGeometry::Point;
+    using H3CoarseGeometry::Vertex;
+
+    constexpr int kMaxCellVertices = 6;
+
+    // Контур без скачков долготы. Разрезанная ячейка сдвигается так, чтобы лежать по обе стороны от 180
+    std::vector<Point> unwrappedBoundary(const H3Index cell, bool& polar)
+    {
+        CellBoundary boundary;
+        cellToBoundary(cell, &boundary);
+
+        std::vector<Point> points;
+        double winding = 0.0;
+        for (int i = 0; i < boundary.numVerts; ++i)
+        {
+            Point point{radsToDegs(boundary.verts[i].lat), radsToDegs(boundary.verts[i].lng)};
+            if (!points.empty())
+            {
+                const double delta = std::remainder(point.lng - points.back().lng, 360.0);
+                point.lng = points.back().lng + delta;
+                winding += delta;
+            }
+            points.push_back(point);
+        }
+        winding += std::remainder(points.front().lng - points.back().lng, 360.0);
+
+        // Контур вокруг полюса набирает полный оборот и не режется
+        polar = std::abs(winding) > 180.0;
+        if (!polar)
+        {
+            const auto lowest = std::min_element(points.begin(), points.end(),
+                                                 [](const Point& a, const Point& b) { return a.lng < b.lng; });
+            if (lowest->lng < -180.0)
+            {
+                for (Point& point : points)
+                    point.lng += 360.0;
+            }
+        }
+        return points;
+    }
+
+    // Отсечение Сазерленда-Ходжмана по меридиану 180: keepEastern - часть с долготами до 180 (восточное полушарие)
+    std::vector<Point> clipAt180(const std::vector<Point>& points, const bool keepEastern)
+    {
+        const auto inside = [keepEastern](const Point& point)
+        { return keepEastern ? point.lng <= 180.0 : point.lng >= 180.0; };
+
+        std::vector<Point> result;
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            const Point& current = points[i];
+            const Point& next = points[(i + 1) % points.size()];
+            if (inside(current))
+                result.push_back(current);
+            if (inside(current) != inside(next))
+            {
+                const double t = (180.0 - current.lng) / (next.lng - current.lng);
+                result.push_back({current.lat + t * (next.lat - current.lat), 180.0});
+            }
+        }
+
+        if (!keepEastern)
+        {
+            for (Point& point : result)
+                point.lng -= 360.0;
+        }
+        return result;
+    }
+
+    void writePoints(FILE* out, const char* name, const std::vector<Point>& points)
+    {
+        std::fprintf(out, "extern const Point %s[] = {\n", name);
+        for (const Point& point : points)
+            std::fprintf(out, "    {%.17g, %.17g},\n", point.lat, point.lng);
+        // Массив нулевой длины недопустим
+        if (points.empty())
+            std::fprintf(out, "    {0.0, 0.0},\n");
+        std::fprintf(out, "};\n\n");
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "Usage: h3-coarse-gen <output.cpp>\n");
+        return 1;
+    }
+
+    std::vector<H3Index> baseCells(res0CellCount());
+    getRes0Cells(baseCells.data());
+
+    std::vector<H3Index> indexes;
+    for (int resolution = 0; resolution <= H3CoarseGeometry::kMaxResolution; ++resolution)
+    {
+        for (const H3Index base : baseCells)
+        {
+            int64_t childCount = 0;
+            cellToChildrenSize(base, resolution, &childCount);
+            std::vector<H3Index> children(childCount);
+            cellToChildren(base, resolution, children.data());
+            indexes.insert(indexes.end(), children.begin(), children.end());
+        }
+    }
+    std::sort(indexes.begin(), indexes.end());
+
+    std::vector<Cell> cells;
+    std::vector<Vertex> vertices;
+    std::map<H3Index, uint32_t> vertexIds;
+    std::vector<uint32_t> rings;
+    std::vector<Point> boundaryPoints;
+    std::vector<Point> splitPoints;
+
+    for (const H3Index index : indexes)
+    {
+        Cell cell{};
+        cell.index = index;
+
+        LatLng center;
+        cellToLatLng(index, &center);
+        cell.lat = radsToDegs(center.lat);
+        cell.lng = radsToDegs(center.lng);
+
+        H3Index vertexes[kMaxCellVertices];
+        cellToVertexes(index, vertexes);
+        cell.ringOffset = static_cast<uint32_t>(rings.size());
+        for (const H3Index vertex : vertexes)
+        {
+            if (vertex == H3_NULL)
+                continue;
+            const auto [it, inserted] = vertexIds.try_emplace(vertex, static_cast<uint32_t>(vertices.size()));
+            if (inserted)
+            {
+                LatLng point;
+                vertexToLatLng(vertex, &point);
+                vertices.push_back({vertex, radsToDegs(point.lat), radsToDegs(point.lng)});
+            }
+            rings.push_back(it->second);
+        }
+        cell.ringSize = static_cast<uint32_t>(rings.size()) - cell.ringOffset;
+
+        bool polar = false;
+        const std::vector<Point> points = unwrappedBoundary(index, polar);
+        cell.boundaryOffset = static_cast<uint32_t>(boundaryPoints.size());
+        cell.boundarySize = static_cast<uint32_t>(points.size());
+        boundaryPoints.insert(boundaryPoints.end(), points.begin(), points.end());
+
+        cell.south = 90.0;
+        cell.north = -90.0;
+        cell.west = 360.0;
+        cell.east = -360.0;
+        for (const Point& point : points)
+        {
+            cell.south = std::min(cell.south, point.lat);
+            cell.north = std::max(cell.north, point.lat);
+            cell.west = std::min(cell.west, point.lng);
+            cell.east = std::max(cell.east, point.lng);
+        }
+
+        if (polar)
+        {
+            cell.west = -180.0;
+            cell.east = 180.0;
+            if (cell.lat > 0.0)
+                cell.north = 90.0;
+            else
+                cell.south = -90.0;
+        }
+        else if (cell.east > 180.0)
+        {
+            const std::vector<Point> eastern = clipAt180(points, true);
+            const std::vector<Point> western = clipAt180(points, false);
+            cell.splitOffset = static_cast<uint32_t>(splitPoints.size());
+            cell.easternSize = static_cast<uint32_t>(eastern.size());
+            cell.westernSize = static_cast<uint32_t>(western.size());
+            splitPoints.insert(splitPoints.end(), eastern.begin(), eastern.end());
+            splitPoints.insert(splitPoints.end(), western.begin(), western.end());
+        }
+        cells.push_back(cell);
+    }
+
+    FILE* out = std::fopen(argv[1], "w");
+    if (!out)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    std::fprintf(out, "// Сгенерировано h3-coarse-gen, не редактировать\n\n");
+    std::fprintf(out, "#include \"h3CoarseGeometry.h\"\n\n");
+    std::fprintf(out, "namespace H3CoarseGeometry::detail\n{\n\n");
+
+    std::fprintf(out, "extern const Cell kCells[] = {\n");
+    for (const Cell& cell : cells)
+    {
+        std::fprintf(out, "    {0x%llxULL, %.17g, %.17g, %.17g, %.17g, %.17g, %.17g, %u, %u, %u, %u, %u, %u, %u},\n",
+                     static_cast<unsigned long long>(cell.index), cell.lat, cell.lng, cell.west, cell.south, cell.east,
+                     cell.north, cell.ringOffset, cell.ringSize, cell.boundaryOffset, cell.boundarySize,
+                     cell.splitOffset, cell.easternSize, cell.westernSize);
+    }
+    std::fprintf(out, "};\nextern const size_t kCellCount = %zu;\n\n", cells.size());
+
+    std::fprintf(out, "extern const Vertex kVertices[] = {\n");
+    for (const Vertex& vertex : vertices)
+    {
+        std::fprintf(out, "    {0x%llxULL, %.17g, %.17g},\n", static_cast<unsigned long long>(vertex.index),
+                     vertex.lat, vertex.lng);
+    }
+    std::fprintf(out, "};\nextern const size_t kVertexCount = %zu;\n\n", vertices.size());
+
+    std::fprintf(out, "extern const uint32_t kRings[] = {\n");
+    for (size_t i = 0; i < rings.size(); ++i)
+        std::fprintf(out, "%s%u,%s", i % 16 == 0 ? "    " : " ", rings[i], i % 16 == 15 ? "\n" : "");
+    std::fprintf(out, "\n};\n\n");
+
+    writePoints(out, "kBoundaryPoints", boundaryPoints);
+    writePoints(out, "kSplitPoints", splitPoints);
+
+    std::fprintf(out, "} // namespace H3CoarseGeometry::detail\n");
+    return std::fclose(out) == 0 ? 0 : 1;
+}
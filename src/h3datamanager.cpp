@@ -6,66 +6,25 @@
 
 #include <QDebug>
 #include <algorithm>
+#include <limits>
 #include <utility>
 
-H3ComputeTask::H3ComputeTask(const QGeoRectangle& viewport, const int resolution,
-                             std::function<void(std::vector<H3Index>)> callback) :
-    m_viewport(viewport), m_resolution(resolution), m_callback(std::move(callback))
+H3DataManager::H3DataManager(QObject* parent) :
+    QObject(parent), m_cacheEnabled(true)
 {
+    m_cache.setMaxCost(5000); // По умолчанию кешируем до 1000 элементов
 }
 
-void H3ComputeTask::run()
+H3DataManager::~H3DataManager()
 {
-    std::vector<H3Index> result;
-
-    if (m_viewport.isValid())
-    {
-        // Получаем углы viewport
-        const QGeoCoordinate topLeft = m_viewport.topLeft();
-        const QGeoCoordinate bottomRight = m_viewport.bottomRight();
-
-        // Преобразуем в H3 GeoPolygon
-        std::vector<LatLng> verts;
-        verts.push_back({degsToRads(topLeft.latitude()), degsToRads(topLeft.longitude())});
-        verts.push_back({degsToRads(topLeft.latitude()), degsToRads(bottomRight.longitude())});
-        verts.push_back({degsToRads(bottomRight.latitude()), degsToRads(bottomRight.longitude())});
-        verts.push_back({degsToRads(bottomRight.latitude()), degsToRads(topLeft.longitude())});
-
-        GeoPolygon polygon;
-        polygon.geoloop.verts = verts.data();
-        polygon.geoloop.numVerts = verts.size();
-        polygon.numHoles = 0;
-        polygon.holes = nullptr;
-
-        // Оцениваем количество гексагонов
-        int64_t numHexagons = 0;
-        auto error = maxPolygonToCellsSize(&polygon, m_resolution, 0, &numHexagons);
-
-        if (numHexagons > 0 && numHexagons < 100000)
-        {
-            result.resize(numHexagons);
-            polygonToCells(&polygon, m_resolution, 0, result.data());
-
-            // Удаляем нулевые индексы
-            std::erase(result, 0);
-        }
-    }
-
-    if (m_callback)
+    // Задача прогрева держит this
+    if (m_warmupSubmitted)
     {
-        m_callback(std::move(result));
+        m_warmupToken.cancel();
+        H3TaskScheduler::instance().waitForDone();
     }
 }
 
-H3DataManager::H3DataManager(QObject* parent) :
-    QObject(parent), m_cacheEnabled(true), m_threadPool(new QThreadPool(this))
-{
-    m_cache.setMaxCost(5000); // По умолчанию кешируем до 1000 элементов
-    m_threadPool->setMaxThreadCount(QThread::idealThreadCount());
-}
-
-H3DataManager::~H3DataManager() { m_threadPool->waitForDone(); }
-
 void H3DataManager::setCacheEnabled(const bool enabled)
 {
     if (m_cacheEnabled == enabled)
@@ -92,9 +51,40 @@ void H3DataManager::setHexagonData(const H3Index index, const H3Data& data)
 {
     QMutexLocker locker(&m_mutex);
     m_data[index] = data;
+    m_sortedIndexDirty = true;
+    ++m_dataVersion;
+    locker.unlock();
+    scheduleIndexWarmup();
+
+    // Сигнал вне блокировки: подписчики сразу читают данные обратно
     emit dataUpdated(index);
 }
 
+void H3DataManager::setValues(const std::vector<std::pair<H3Index, double>>& values)
+{
+    if (values.empty())
+        return;
+
+    QList<H3Index> indices;
+    indices.reserve(values.size());
+
+    QMutexLocker locker(&m_mutex);
+    for (const auto& [index, value] : values)
+    {
+        // Свойства и цвет ячейки сохраняются, меняется только значение
+        H3Data& data = m_data[index];
+        data.index = index;
+        data.value = value;
+        indices.append(index);
+    }
+    m_sortedIndexDirty = true;
+    ++m_dataVersion;
+    locker.unlock();
+    scheduleIndexWarmup();
+
+    emit dataBatchUpdated(indices);
+}
+
 H3Data H3DataManager::getHexagonData(const H3Index index) const
 {
     QMutexLocker locker(&m_mutex);
@@ -105,29 +95,261 @@ H3Data H3DataManager::getHexagonData(const H3Index index) const
     return H3Data();
 }
 
+bool H3DataManager::hasHexagonData(const H3Index index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_data.contains(index);
+}
+
+bool H3DataManager::isEmpty() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_data.empty();
+}
+
+void H3DataManager::valuesOf(const std::vector<H3Index>& cells, std::vector<double>& values) const
+{
+    values.resize(cells.size());
+
+    QMutexLocker locker(&m_mutex);
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        const auto it = m_data.find(cells[i]);
+        values[i] = it != m_data.end() ? it->second.value : std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
 void H3DataManager::clearData()
 {
     QMutexLocker locker(&m_mutex);
     m_data.clear();
+    m_sortedIndex.clear();
+    m_sortedIndexDirty = false;
+    ++m_dataVersion;
     m_aggregatedValues.clear();
     m_cache.clear();
+    m_seriesSlots.clear();
+    m_seriesValues.clear();
+    locker.unlock();
+
+    emit dataCleared();
 }
 
-void H3DataManager::aggregateToParent(const H3Index childIndex, const double value)
+void H3DataManager::ensureSortedIndex() const
+{
+    // Вызывается под m_mutex
+    if (!m_sortedIndexDirty)
+        return;
+
+    std::vector<H3SortedIndex::Entry> entries;
+    entries.reserve(m_data.size());
+    for (const auto& [index, data] : m_data)
+        entries.push_back({index, data.value});
+    m_sortedIndex.build(std::move(entries));
+    m_sortedIndexDirty = false;
+}
+
+void H3DataManager::setIndexWarmup(const bool enabled)
 {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_indexWarmup = enabled;
+    }
+    if (enabled)
+        scheduleIndexWarmup();
+}
+
+void H3DataManager::scheduleIndexWarmup()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        // Одна задача в очереди на любое число изменений
+        if (!m_indexWarmup || !m_sortedIndexDirty || m_warmupQueued)
+            return;
+        m_warmupQueued = true;
+        m_warmupSubmitted = true;
+    }
+
+    H3TaskScheduler::instance().submit(
+        TaskPriority::Maintenance, [this](const CancellationToken&) { warmupIndex(); }, m_warmupToken);
+}
+
+void H3DataManager::warmupIndex()
+{
+    std::vector<H3SortedIndex::Entry> entries;
+    quint64 version = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_warmupQueued = false;
+        if (!m_sortedIndexDirty)
+            return;
+
+        version = m_dataVersion;
+        entries.reserve(m_data.size());
+        for (const auto& [index, data] : m_data)
+            entries.push_back({index, data.value});
+    }
+
+    // Сортировка без мьютекса: запись и чтение значений её не ждут
+    H3SortedIndex index;
+    index.build(std::move(entries));
+
     QMutexLocker locker(&m_mutex);
+    // Данные успели измениться - индекс устарел, следующую перестройку уже поставило изменение
+    if (version != m_dataVersion || !m_sortedIndexDirty)
+        return;
+    m_sortedIndex = std::move(index);
+    m_sortedIndexDirty = false;
+}
 
-    // Получаем родительский индекс
-    H3Index parentIndex = 0;
-    auto error = cellToParent(childIndex, getResolution(childIndex) - 1, &parentIndex);
+double H3DataManager::sumDescendants(const H3Index parent, const int resolution) const
+{
+    QMutexLocker locker(&m_mutex);
+    ensureSortedIndex();
+    return m_sortedIndex.sumDescendants(parent, resolution);
+}
 
-    // Агрегируем значение
-    m_aggregatedValues[parentIndex] += value;
+std::vector<H3SortedIndex::Entry> H3DataManager::rollup(const int childResolution, const int parentResolution) const
+{
+    QMutexLocker locker(&m_mutex);
+    ensureSortedIndex();
+    return m_sortedIndex.rollup(childResolution, parentResolution);
+}
 
-    // Рекурсивно агрегируем вверх по иерархии
-    if (getResolution(parentIndex) > 0)
+std::vector<H3SortedIndex::Entry> H3DataManager::valuesInCover(const std::vector<H3Index>& cover,
+                                                               const int resolution) const
+{
+    QMutexLocker locker(&m_mutex);
+    ensureSortedIndex();
+
+    std::vector<H3SortedIndex::Entry> result;
+    const std::vector<H3SortedIndex::Entry>& cells = m_sortedIndex.cells(std::clamp(resolution, 0, H3SortedIndex::kMaxResolution));
+    for (const auto& [first, last] : m_sortedIndex.intersect(cover, resolution))
+        result.insert(result.end(), cells.begin() + first, cells.begin() + last);
+    return result;
+}
+
+int H3DataManager::timeBucketCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_timeBucketCount;
+}
+
+void H3DataManager::setTimeBucketCount(const int count)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_timeBucketCount == std::max(count, 0))
+        return;
+
+    m_timeBucketCount = std::max(count, 0);
+    m_seriesSlots.clear();
+    m_seriesValues.clear();
+    locker.unlock();
+
+    emit timeSeriesChanged();
+}
+
+void H3DataManager::setTimeSeries(const H3Index index, const float* values, const int count)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_timeBucketCount == 0)
+        return;
+
+    const auto [it, inserted] = m_seriesSlots.try_emplace(index, static_cast<int>(m_seriesSlots.size()));
+    if (inserted)
+        m_seriesValues.resize(m_seriesSlots.size() * m_timeBucketCount, std::numeric_limits<float>::quiet_NaN());
+
+    float* row = m_seriesValues.data() + static_cast<size_t>(it->second) * m_timeBucketCount;
+    const int copied = std::min(count, m_timeBucketCount);
+    std::copy_n(values, copied, row);
+    std::fill(row + copied, row + m_timeBucketCount, std::numeric_limits<float>::quiet_NaN());
+    locker.unlock();
+
+    emit timeSeriesChanged();
+}
+
+void H3DataManager::setTimeSeriesBatch(const std::vector<H3Index>& indices, const std::vector<float>& values)
+{
+    QMutexLocker locker(&m_mutex);
+    const size_t stride = m_timeBucketCount;
+    if (stride == 0 || values.size() < indices.size() * stride)
+        return;
+
+    m_seriesSlots.reserve(m_seriesSlots.size() + indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        const auto [it, inserted] = m_seriesSlots.try_emplace(indices[i], static_cast<int>(m_seriesSlots.size()));
+        if (inserted)
+            m_seriesValues.resize(m_seriesSlots.size() * stride);
+        std::copy_n(values.data() + i * stride, stride, m_seriesValues.data() + static_cast<size_t>(it->second) * stride);
+    }
+    locker.unlock();
+
+    emit timeSeriesChanged();
+}
+
+void H3DataManager::setTimeValue(const H3Index index, const int bucket, const double value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (bucket < 0 || bucket >= m_timeBucketCount)
+        return;
+
+    const auto [it, inserted] = m_seriesSlots.try_emplace(index, static_cast<int>(m_seriesSlots.size()));
+    if (inserted)
+        m_seriesValues.resize(m_seriesSlots.size() * m_timeBucketCount, std::numeric_limits<float>::quiet_NaN());
+
+    m_seriesValues[static_cast<size_t>(it->second) * m_timeBucketCount + bucket] = static_cast<float>(value);
+    locker.unlock();
+
+    emit timeSeriesChanged();
+}
+
+void H3DataManager::seriesSlots(const std::vector<H3Index>& cells, std::vector<int>& slots) const
+{
+    slots.resize(cells.size());
+
+    QMutexLocker locker(&m_mutex);
+    for (size_t i = 0; i < cells.size(); ++i)
     {
-        aggregateToParent(parentIndex, value);
+        const auto it = m_seriesSlots.find(cells[i]);
+        slots[i] = it != m_seriesSlots.end() ? it->second : -1;
+    }
+}
+
+void H3DataManager::sampleTimeBucket(const std::vector<int>& slots, const int bucket, std::vector<float>& out) const
+{
+    out.resize(slots.size());
+
+    QMutexLocker locker(&m_mutex);
+    if (bucket < 0 || bucket >= m_timeBucketCount)
+    {
+        std::fill(out.begin(), out.end(), std::numeric_limits<float>::quiet_NaN());
+        return;
+    }
+
+    // Шаг по рядам постоянный, поэтому выборка - один линейный проход без поиска по хешу
+    const float* column = m_seriesValues.data() + bucket;
+    const size_t stride = m_timeBucketCount;
+    constexpr float missing = std::numeric_limits<float>::quiet_NaN();
+    for (size_t i = 0; i < slots.size(); ++i)
+        out[i] = slots[i] >= 0 ? column[static_cast<size_t>(slots[i]) * stride] : missing;
+}
+
+void H3DataManager::aggregateToParent(const H3Index childIndex, const double value)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Поднимаемся по иерархии циклом: рекурсивный вызов повторно захватывал бы нерекурсивный m_mutex
+    H3Index index = childIndex;
+    for (int resolution = getResolution(index) - 1; resolution >= 0; --resolution)
+    {
+        H3Index parentIndex = 0;
+        if (cellToParent(index, resolution, &parentIndex) != E_SUCCESS)
+            break;
+
+        // Агрегируем значение
+        m_aggregatedValues[parentIndex] += value;
+        index = parentIndex;
     }
 }
 
@@ -181,48 +403,6 @@ QList<H3Index> H3DataManager::getNeighbors(const H3Index index, const int k)
     return result;
 }
 
-// void H3DataManager::getHexagonsInViewportAsync(const QGeoRectangle& viewport, int resolution,
-//                                                std::function<void(std::vector<H3Index>)> callback)
-// {
-//     emit computationStarted();
-//
-//     // Проверяем кеш
-//     if (m_cacheEnabled)
-//     {
-//         qDebug() << "cache";
-//         // Простой ключ кеша на основе viewport и resolution
-//         const H3Index cacheKey = geoToH3(viewport.center(), resolution);
-//
-//         if (const auto cached = m_cache.object(cacheKey))
-//         {
-//             callback(*cached);
-//             emit computationFinished();
-//             return;
-//         }
-//     }
-//
-//     // Создаем задачу для выполнения в отдельном потоке
-//     auto task =
-//         new H3ComputeTask(viewport, resolution,
-//                           [this, callback, viewport, resolution](std::vector<H3Index> result)
-//                           {
-//                               // Кешируем результат
-//                               if (m_cacheEnabled && !result.empty())
-//                               {
-//                                   H3Index cacheKey = geoToH3(viewport.center(), resolution);
-//                                   m_cache.insert(cacheKey, new std::vector<H3Index>(result));
-//                               }
-//
-//                               // Вызываем callback в основном потоке
-//                               QMetaObject::invokeMethod(
-//                                   this, [callback, result]() { callback(std::move(result)); }, Qt::QueuedConnection);
-//
-//                               emit computationFinished();
-//                           });
-//
-//     m_threadPool->start(task);
-// }
-
 QString H3DataManager::h3IndexToString(const H3Index index) { return QString::number(index, 16); }
 
 H3Index H3DataManager::stringToH3Index(const QString& str) { return str.toULongLong(nullptr, 16); }
@@ -6,18 +6,20 @@
 #define H3DATAMANAGER_H
 
 #include <QObject>
-#include <QThreadPool>
-#include <QRunnable>
 #include <QMutex>
 #include <QCache>
 #include <QVariantMap>
 #include <QColor>
 
 #include <h3api.h>
-#include <unordered_map>
+#include <vector>
 #include <memory>
 #include <QGeoRectangle>
 
+#include "h3FlatMap.h"
+#include "h3SortedIndex.h"
+#include "h3TaskScheduler.h"
+
 // Структура для хранения данных гексагона
 struct H3Data {
     H3Index index;
@@ -28,19 +30,6 @@ struct H3Data {
     H3Data() : index(0), value(0.0) {}
 };
 
-// Задача для параллельной обработки
-class H3ComputeTask : public QRunnable {
-public:
-    H3ComputeTask(const QGeoRectangle &viewport, int resolution,
-                  std::function<void(std::vector<H3Index>)> callback);
-    void run() override;
-
-private:
-    QGeoRectangle m_viewport;
-    int m_resolution;
-    std::function<void(std::vector<H3Index>)> m_callback;
-};
-
 // Менеджер данных H3
 class H3DataManager : public QObject {
     Q_OBJECT
@@ -61,19 +50,43 @@ public:
     // Работа с данными
     Q_INVOKABLE void setHexagonData(H3Index index, const H3Data &data);
     Q_INVOKABLE H3Data getHexagonData(H3Index index) const;
+    Q_INVOKABLE bool hasHexagonData(H3Index index) const;
+    bool isEmpty() const;
+    // Пакетная запись значений: один захват мьютекса и один сигнал dataBatchUpdated на весь пакет
+    void setValues(const std::vector<std::pair<H3Index, double>> &values);
+    // Значения набора ячеек за один захват мьютекса: NaN - данных по ячейке нет
+    void valuesOf(const std::vector<H3Index> &cells, std::vector<double> &values) const;
     Q_INVOKABLE void clearData();
 
+    // Временные ряды: значения ячейки по временным корзинам лежат подряд (stride = timeBucketCount),
+    // пропуски хранятся как NaN. Смена числа корзин сбрасывает ряды
+    int timeBucketCount() const;
+    void setTimeBucketCount(int count);
+    void setTimeSeries(H3Index index, const float *values, int count);
+    // Ряды сразу для набора ячеек: values - по timeBucketCount значений на ячейку подряд
+    void setTimeSeriesBatch(const std::vector<H3Index> &indices, const std::vector<float> &values);
+    Q_INVOKABLE void setTimeValue(H3Index index, int bucket, double value);
+    // Слоты рядов для набора ячеек (-1 - ряда нет), один захват мьютекса на весь набор
+    void seriesSlots(const std::vector<H3Index> &cells, std::vector<int> &slots) const;
+    // Значения одной корзины для набора слотов за один проход; слот -1 даёт NaN
+    void sampleTimeBucket(const std::vector<int> &slots, int bucket, std::vector<float> &out) const;
+
     // Агрегация данных
     Q_INVOKABLE void aggregateToParent(H3Index childIndex, double value);
     Q_INVOKABLE double getAggregatedValue(H3Index index) const;
 
+    // Запросы по отсортированному индексу значений (перестраивается лениво после изменений данных)
+    // Прогрев: после изменений индекс перестраивается фоновой задачей обслуживания, и первый запрос
+    // не сортирует под мьютексом. Включают те, кто читает индекс постоянно
+    void setIndexWarmup(bool enabled);
+    Q_INVOKABLE double sumDescendants(H3Index parent, int resolution) const;
+    std::vector<H3SortedIndex::Entry> rollup(int childResolution, int parentResolution) const;
+    // Значения ячеек resolution, попавших в покрытие viewport (ячейки покрытия не мельче resolution)
+    std::vector<H3SortedIndex::Entry> valuesInCover(const std::vector<H3Index> &cover, int resolution) const;
+
     // Вычисление соседей
     Q_INVOKABLE static QList<H3Index> getNeighbors(H3Index index, int k = 1);
 
-    // Оптимизированное получение гексагонов
-    // void getHexagonsInViewportAsync(const QGeoRectangle &viewport, int resolution,
-    //                                std::function<void(std::vector<H3Index>)> callback);
-
     // Утилиты
     Q_INVOKABLE static QString h3IndexToString(H3Index index);
     Q_INVOKABLE static H3Index stringToH3Index(const QString &str);
@@ -87,16 +100,30 @@ signals:
     void cacheEnabledChanged();
     void cacheSizeChanged();
     void dataUpdated(H3Index index);
-    void computationStarted();
-    void computationFinished();
+    void dataBatchUpdated(const QList<H3Index> &indices);
+    void dataCleared();
+    void timeSeriesChanged();
 
 private:
+    void ensureSortedIndex() const;
+    void scheduleIndexWarmup();
+    void warmupIndex();
+
     mutable QMutex m_mutex;
-    std::unordered_map<H3Index, H3Data> m_data;
-    std::unordered_map<H3Index, double> m_aggregatedValues;
+    H3FlatMap<H3Data> m_data;
+    H3FlatMap<double> m_aggregatedValues;
+    mutable H3SortedIndex m_sortedIndex;
+    mutable bool m_sortedIndexDirty{true};
+    quint64 m_dataVersion{0}; // Растёт с каждым изменением значений: прогрев не ставит устаревший индекс
+    bool m_indexWarmup{false};
+    bool m_warmupQueued{false};
+    bool m_warmupSubmitted{false}; // Деструктор ждёт задачу, только если она когда-то ставилась
+    CancellationToken m_warmupToken;
     QCache<H3Index, std::vector<H3Index>> m_cache;
+    int m_timeBucketCount{0};
+    H3FlatMap<int> m_seriesSlots;
+    std::vector<float> m_seriesValues; // [slot * m_timeBucketCount + bucket]
     bool m_cacheEnabled{true};
-    QThreadPool *m_threadPool;
 };
 
 
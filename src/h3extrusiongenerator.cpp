@@ -0,0 +1,253 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3extrusiongenerator.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cmath>
+
+#include "h3TaskScheduler.h"
+#include "h3datamanager.h"
+#include "h3model.h"
+#include "h3tilegenerator.h"
+#include "instrumentation.h"
+#include "mvtEncoder.h"
+#include "tileMath.h"
+
+namespace
+{
+    constexpr quint32 kExtent = 4096;
+    constexpr int kCacheBytes = 64 * 1024 * 1024;
+    constexpr int kRevisionIntervalMs = 500;
+
+    // Тайл зума z, в который попадает центр ячейки
+    QPoint centerTile(const LatLng& center, const int z)
+    {
+        const int tiles = 1 << z;
+        const int x = std::clamp(static_cast<int>(TileMath::lngToTileX(radsToDegs(center.lng), z)), 0, tiles - 1);
+        const int y = std::clamp(static_cast<int>(TileMath::latToTileY(radsToDegs(center.lat), z)), 0, tiles - 1);
+        return {x, y};
+    }
+} // namespace
+
+H3ExtrusionTileGenerator::H3ExtrusionTileGenerator(H3DataManager* dataManager, QObject* parent) :
+    QObject(parent), m_dataManager(dataManager)
+{
+    m_cache.setMaxCost(kCacheBytes);
+
+    m_revisionTimer.setSingleShot(true);
+    m_revisionTimer.setInterval(kRevisionIntervalMs);
+    connect(&m_revisionTimer, &QTimer::timeout, this,
+            [this]()
+            {
+                ++m_revision;
+                emit revisionChanged();
+            });
+
+    connectDataManager();
+}
+
+void H3ExtrusionTileGenerator::setDataManager(H3DataManager* dataManager)
+{
+    if (m_dataManager == dataManager)
+        return;
+
+    if (m_dataManager)
+    {
+        disconnect(m_dataManager, nullptr, this, nullptr);
+        m_dataManager->setIndexWarmup(false);
+    }
+    {
+        QWriteLocker locker(&m_dataLock);
+        m_dataManager = dataManager;
+    }
+    connectDataManager();
+    invalidate();
+}
+
+void H3ExtrusionTileGenerator::connectDataManager()
+{
+    if (!m_dataManager)
+        return;
+
+    // Каждый тайл читает отсортированный индекс - пусть он перестраивается в фоне, а не в запросе тайла
+    m_dataManager->setIndexWarmup(true);
+
+    connect(m_dataManager, &H3DataManager::dataUpdated, this,
+            [this](const H3Index index) { invalidateCells({index}); });
+    connect(m_dataManager, &H3DataManager::dataBatchUpdated, this, &H3ExtrusionTileGenerator::invalidateCells);
+    connect(m_dataManager, &H3DataManager::dataCleared, this, &H3ExtrusionTileGenerator::invalidate);
+}
+
+void H3ExtrusionTileGenerator::setEnabled(const bool enabled)
+{
+    if (m_enabled.exchange(enabled) == enabled)
+        return;
+
+    invalidate();
+    emit enabledChanged();
+}
+
+QFuture<QByteArray> H3ExtrusionTileGenerator::requestTile(const int z, const int x, const int y)
+{
+    if (!m_enabled.load())
+        return QtFuture::makeReadyFuture(QByteArray());
+
+    const quint64 key = tileKey(z, x, y);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const QByteArray* cached = m_cache.object(key))
+        {
+            H3_COUNTER_ADD(ExtrusionCacheHits, 1);
+            return QtFuture::makeReadyFuture(*cached);
+        }
+    }
+
+    H3_COUNTER_ADD(ExtrusionCacheMisses, 1);
+    const quint64 version = m_version.load();
+    const auto generate = [this, z, x, y, key, version]()
+    {
+        QByteArray tile = generateTile(z, x, y);
+
+        QMutexLocker locker(&m_cacheMutex);
+        if (version == m_version.load())
+        {
+            m_cache.insert(key, new QByteArray(tile), std::max<qsizetype>(1, tile.size()));
+        }
+        return tile;
+    };
+
+    // Тайлы видимой области не ждут фоновой загрузки и обслуживания данных
+    return H3TaskScheduler::instance().run(TaskPriority::Interactive, generate);
+}
+
+QByteArray H3ExtrusionTileGenerator::tileJson(const QString& tilesUrl) const
+{
+    QJsonObject tileJson;
+    tileJson.insert("tilejson", "2.2.0");
+    tileJson.insert("name", "h3extrusion");
+    tileJson.insert("scheme", "xyz");
+    tileJson.insert("tiles", QJsonArray{tilesUrl});
+    tileJson.insert("minzoom", 0);
+    tileJson.insert("maxzoom", kMaxZoom);
+    tileJson.insert("vector_layers",
+                    QJsonArray{QJsonObject{{"id", "h3"},
+                                           {"fields", QJsonObject{{"h3", "String"}, {"value", "Number"}}}}});
+
+    return QJsonDocument(tileJson).toJson(QJsonDocument::Compact);
+}
+
+QByteArray H3ExtrusionTileGenerator::generateTile(const int z, const int x, const int y) const
+{
+    QReadLocker locker(&m_dataLock);
+    if (!m_dataManager)
+        return {};
+
+    // Ячейки данных не крупнее сетки этого зума: покрытие тайла сеткой и выборка по отсортированному индексу
+    const int resolution = H3HexagonModel::resolutionForZoom(z);
+    const std::vector<H3Index> cover = H3TileGenerator::cellsInTile(z, x, y, resolution);
+    if (cover.empty())
+        return {};
+
+    MvtLayer layer("h3", kExtent);
+    const quint32 indexKey = layer.key("h3");
+    const quint32 valueKey = layer.key("value");
+
+    const double centerLng = TileMath::tileXToLng(x + 0.5, z);
+    const double worldSize = 1 << z;
+    std::vector<QPoint> ring;
+
+    for (int cellResolution = resolution; cellResolution <= H3SortedIndex::kMaxResolution; ++cellResolution)
+    {
+        for (const H3SortedIndex::Entry& entry : m_dataManager->valuesInCover(cover, cellResolution))
+        {
+            LatLng center;
+            if (cellToLatLng(entry.index, &center) != E_SUCCESS || centerTile(center, z) != QPoint(x, y))
+                continue;
+
+            CellBoundary boundary;
+            if (cellToBoundary(entry.index, &boundary) != E_SUCCESS)
+                continue;
+
+            ring.clear();
+            for (int i = 0; i < boundary.numVerts; ++i)
+            {
+                double lng = radsToDegs(boundary.verts[i].lng);
+                while (lng - centerLng > 180.0)
+                    lng -= 360.0;
+                while (lng - centerLng < -180.0)
+                    lng += 360.0;
+
+                const double tileX = (lng + 180.0) / 360.0 * worldSize - x;
+                const double tileY = TileMath::latToTileY(radsToDegs(boundary.verts[i].lat), z) - y;
+                ring.emplace_back(qRound(tileX * kExtent), qRound(tileY * kExtent));
+            }
+
+            char indexString[17];
+            h3ToString(entry.index, indexString, sizeof(indexString));
+            layer.addPolygon(entry.index, ring,
+                             {indexKey, layer.stringValue(QByteArray(indexString)), valueKey,
+                              layer.doubleValue(entry.value)});
+        }
+    }
+
+    if (layer.isEmpty())
+        return {};
+    return encodeMvtTile({layer});
+}
+
+void H3ExtrusionTileGenerator::invalidate()
+{
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        m_version.fetch_add(1);
+        m_cache.clear();
+    }
+    scheduleRevision();
+}
+
+void H3ExtrusionTileGenerator::invalidateCells(const QList<H3Index>& cells)
+{
+    scheduleRevision();
+
+    QMutexLocker locker(&m_cacheMutex);
+    m_version.fetch_add(1);
+
+    // Большой пакет затрагивает почти все закешированные тайлы - дешевле сбросить кеш целиком
+    if (cells.size() > m_cache.count())
+    {
+        m_cache.clear();
+        return;
+    }
+
+    for (const H3Index cell : cells)
+    {
+        LatLng center;
+        if (cellToLatLng(cell, &center) != E_SUCCESS)
+            continue;
+
+        // Ячейка видна на зумах, где сетка не мельче её разрешения
+        const int cellResolution = getResolution(cell);
+        for (int z = 0; z <= kMaxZoom && H3HexagonModel::resolutionForZoom(z) <= cellResolution; ++z)
+        {
+            const QPoint tile = centerTile(center, z);
+            m_cache.remove(tileKey(z, tile.x(), tile.y()));
+        }
+    }
+}
+
+void H3ExtrusionTileGenerator::scheduleRevision()
+{
+    if (!m_revisionTimer.isActive())
+        m_revisionTimer.start();
+}
+
+quint64 H3ExtrusionTileGenerator::tileKey(const int z, const int x, const int y)
+{
+    return (static_cast<quint64>(z) << 58) | (static_cast<quint64>(x) << 29) | static_cast<quint64>(y);
+}
@@ -0,0 +1,82 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3EXTRUSIONGENERATOR_H
+#define H3EXTRUSIONGENERATOR_H
+
+#include <QCache>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QTimer>
+
+#include <atomic>
+#include <h3api.h>
+
+#include "tileProvider.h"
+
+class H3DataManager;
+
+// Векторные тайлы со столбцами ячеек данных для слоя fill-extrusion: высота и цвет - из значения.
+// Ячейка попадает только в тайл своего центра, поэтому изменение значения сбрасывает по одному тайлу
+// на зум, остальные отдаются из кеша. Новая ревизия в адресе тайлов заставляет MapLibre перезапросить
+// их, и он получает из кеша всё, кроме сброшенных
+class H3ExtrusionTileGenerator : public QObject, public TileProvider {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int revision READ revision NOTIFY revisionChanged)
+    Q_PROPERTY(int maxZoom READ maxZoom CONSTANT)
+    Q_PROPERTY(double maxHeight READ maxHeight CONSTANT)
+
+public:
+    static constexpr int kMaxZoom = 24;
+    static constexpr double kMaxHeight = 5000.0; // Метры для значения 1
+
+    explicit H3ExtrusionTileGenerator(H3DataManager *dataManager, QObject *parent = nullptr);
+
+    // Хранилище значений активного слоя; генератору не принадлежит, nullptr - пустые тайлы
+    void setDataManager(H3DataManager *dataManager);
+
+    bool enabled() const { return m_enabled.load(); }
+    void setEnabled(bool enabled);
+
+    int revision() const { return m_revision; }
+    int maxZoom() const { return kMaxZoom; }
+    double maxHeight() const { return kMaxHeight; }
+
+    QFuture<QByteArray> requestTile(int z, int x, int y) override;
+    QByteArray tileJson(const QString &tilesUrl) const override;
+
+    // Синхронная генерация, безопасна для вызова из любого потока
+    QByteArray generateTile(int z, int x, int y) const;
+
+public slots:
+    void invalidate();
+    // Сброс только тайлов, в которые попадают центры этих ячеек
+    void invalidateCells(const QList<H3Index> &cells);
+
+signals:
+    void enabledChanged();
+    void revisionChanged();
+
+private:
+    void scheduleRevision();
+    void connectDataManager();
+
+    static quint64 tileKey(int z, int x, int y);
+
+    H3DataManager *m_dataManager;
+    mutable QReadWriteLock m_dataLock; // Генерация читает хранилище, смена хранилища ждёт генераций
+    std::atomic<bool> m_enabled{false};
+    std::atomic<quint64> m_version{0}; // Меняется при любом сбросе: результаты начатых генераций не кешируются
+
+    QTimer m_revisionTimer; // Ревизию для MapLibre поднимаем не чаще таймера
+    int m_revision{0};
+
+    mutable QMutex m_cacheMutex;
+    QCache<quint64, QByteArray> m_cache; // Стоимость - размер тайла в байтах
+};
+
+#endif //H3EXTRUSIONGENERATOR_H
@@ -0,0 +1,397 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3layer.h"
+
+#include <QDebug>
+
+#include "typedArrays.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+H3Layer::H3Layer(const QString& name, QObject* parent) :
+    QObject(parent), m_name(name), m_dataManager(new H3DataManager(this))
+{
+    connect(m_dataManager, &H3DataManager::dataUpdated, this, &H3Layer::valueChanged);
+    connect(m_dataManager, &H3DataManager::dataBatchUpdated, this, &H3Layer::valuesChanged);
+    connect(m_dataManager, &H3DataManager::dataCleared, this, &H3Layer::valuesReset);
+    connect(m_dataManager, &H3DataManager::timeSeriesChanged, this, &H3Layer::timeSeriesChanged);
+}
+
+void H3Layer::setVisible(const bool visible)
+{
+    if (m_visible == visible)
+        return;
+
+    m_visible = visible;
+    emit visibleChanged();
+}
+
+void H3Layer::setOpacity(const double opacity)
+{
+    const double clamped = std::clamp(opacity, 0.0, 1.0);
+    if (qFuzzyCompare(m_opacity, clamped))
+        return;
+
+    m_opacity = clamped;
+    emit opacityChanged();
+}
+
+void H3Layer::setMinValue(const double value)
+{
+    if (qFuzzyCompare(m_ramp.minValue(), value))
+        return;
+
+    m_ramp.setRange(value, m_ramp.maxValue());
+    emit rampChanged();
+}
+
+void H3Layer::setMaxValue(const double value)
+{
+    if (qFuzzyCompare(m_ramp.maxValue(), value))
+        return;
+
+    m_ramp.setRange(m_ramp.minValue(), value);
+    emit rampChanged();
+}
+
+QVariantList H3Layer::colorRamp() const
+{
+    QVariantList colors;
+    colors.reserve(m_ramp.stops().size());
+    for (const QColor& color : m_ramp.stops())
+        colors.append(color);
+    return colors;
+}
+
+void H3Layer::setColorRamp(const QVariantList& colors)
+{
+    std::vector<QColor> ramp;
+    ramp.reserve(colors.size());
+    for (const QVariant& color : colors)
+    {
+        const QColor parsed = color.value<QColor>();
+        if (parsed.isValid())
+            ramp.push_back(parsed);
+    }
+
+    if (!m_ramp.setStops(std::move(ramp)))
+        return;
+
+    emit rampChanged();
+}
+
+void H3Layer::setNoDataColor(const QColor& color)
+{
+    if (m_ramp.noDataColor() == color)
+        return;
+
+    m_ramp.setNoDataColor(color);
+    emit rampChanged();
+}
+
+void H3Layer::setValue(const QString& h3Index, const double value)
+{
+    const H3Index index = H3DataManager::stringToH3Index(h3Index);
+    if (!isValidCell(index))
+        return;
+
+    H3Data data;
+    data.index = index;
+    data.value = value;
+    m_dataManager->setHexagonData(index, data);
+}
+
+void H3Layer::setTimeSeries(const QString& h3Index, const QVariantList& values)
+{
+    const H3Index index = H3DataManager::stringToH3Index(h3Index);
+    if (!isValidCell(index) || values.isEmpty())
+        return;
+
+    if (m_dataManager->timeBucketCount() == 0)
+        m_dataManager->setTimeBucketCount(values.size());
+
+    std::vector<float> series;
+    series.reserve(values.size());
+    for (const QVariant& value : values)
+    {
+        bool ok = false;
+        const double number = value.toDouble(&ok);
+        series.push_back(ok ? static_cast<float>(number) : std::numeric_limits<float>::quiet_NaN());
+    }
+    m_dataManager->setTimeSeries(index, series.data(), static_cast<int>(series.size()));
+}
+
+void H3Layer::clear() { m_dataManager->clearData(); }
+
+int H3Layer::setValuesFromArrays(const QJSValue& indexHigh, const QJSValue& indexLow, const QJSValue& values)
+{
+    std::vector<H3Index> indices;
+    std::vector<double> numbers;
+    if (!TypedArrays::readIndices(indexHigh, indexLow, indices) ||
+        !TypedArrays::readValues(values, indices.size(), numbers))
+    {
+        qWarning() << "setValuesFromArrays: expected Uint32Array pairs and Float32Array/Float64Array of equal length";
+        return 0;
+    }
+
+    std::vector<std::pair<H3Index, double>> batch;
+    batch.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        if (isValidCell(indices[i]))
+            batch.emplace_back(indices[i], numbers[i]);
+    }
+    m_dataManager->setValues(batch);
+    return static_cast<int>(batch.size());
+}
+
+int H3Layer::setTimeSeriesFromArrays(const QJSValue& indexHigh, const QJSValue& indexLow, const QJSValue& values,
+                                     const int bucketCount)
+{
+    if (bucketCount <= 0)
+        return 0;
+
+    if (m_dataManager->timeBucketCount() == 0)
+        m_dataManager->setTimeBucketCount(bucketCount);
+    if (m_dataManager->timeBucketCount() != bucketCount)
+    {
+        qWarning() << "setTimeSeriesFromArrays: layer" << m_name << "has" << m_dataManager->timeBucketCount()
+                   << "time buckets, got" << bucketCount;
+        return 0;
+    }
+
+    std::vector<H3Index> indices;
+    std::vector<double> numbers;
+    if (!TypedArrays::readIndices(indexHigh, indexLow, indices) ||
+        !TypedArrays::readValues(values, indices.size() * bucketCount, numbers))
+    {
+        qWarning() << "setTimeSeriesFromArrays: expected Uint32Array pairs and count * bucketCount values";
+        return 0;
+    }
+
+    // Невалидные ячейки выкидываем вместе с их рядами
+    std::vector<H3Index> cells;
+    std::vector<float> series;
+    cells.reserve(indices.size());
+    series.reserve(numbers.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        if (!isValidCell(indices[i]))
+            continue;
+        cells.push_back(indices[i]);
+        for (int bucket = 0; bucket < bucketCount; ++bucket)
+            series.push_back(static_cast<float>(numbers[i * bucketCount + bucket]));
+    }
+    m_dataManager->setTimeSeriesBatch(cells, series);
+    return static_cast<int>(cells.size());
+}
+
+bool H3Layer::hasValue(const H3Index index) const { return m_dataManager->hasHexagonData(index); }
+
+double H3Layer::value(const H3Index index) const { return m_dataManager->getHexagonData(index).value; }
+
+QColor H3Layer::colorFor(const H3Index index) const
+{
+    const H3Data data = m_dataManager->getHexagonData(index);
+    if (data.index == 0)
+        return m_ramp.noDataColor();
+    return data.color.isValid() ? data.color : rampColor(data.value);
+}
+
+QColor H3Layer::rampColor(const double value) const { return m_ramp.color(value); }
+
+void H3Layer::rampColors(const std::vector<float>& values, std::vector<QRgb>& colors) const
+{
+    m_ramp.colors(values, colors);
+}
+
+H3LayerModel::H3LayerModel(H3HexagonModel* tessellation, H3Layer* layer, QObject* parent) :
+    QIdentityProxyModel(parent), m_tessellation(tessellation), m_layer(layer)
+{
+    setSourceModel(tessellation);
+
+    connect(m_layer, &H3Layer::valueChanged, this, &H3LayerModel::onValueChanged);
+    connect(m_layer, &H3Layer::valuesChanged, this, &H3LayerModel::onValuesChanged);
+    connect(m_layer, &H3Layer::valuesReset, this, &H3LayerModel::scheduleRefresh);
+    connect(m_layer, &H3Layer::rampChanged, this, &H3LayerModel::refreshColors);
+    connect(m_layer, &H3Layer::timeSeriesChanged, this, &H3LayerModel::scheduleRefresh);
+
+    // Новый набор ячеек - слоты рядов пересчитаются при первом обращении
+    if (tessellation)
+        connect(tessellation, &QAbstractItemModel::modelAboutToBeReset, this, [this]() { m_slotsDirty = true; });
+}
+
+void H3LayerModel::setCurrentTime(const int bucket)
+{
+    if (m_currentTime == bucket)
+        return;
+
+    m_currentTime = bucket;
+    emit currentTimeChanged();
+
+    if (m_layer->timeBucketCount() == 0 || rowCount() == 0)
+        return;
+
+    ensureSlots();
+    sampleCurrentTime();
+    emit dataChanged(index(0, 0), index(rowCount() - 1, 0), {ValueRole, HasValueRole, ColorRole});
+}
+
+QVariant H3LayerModel::data(const QModelIndex& index, const int role) const
+{
+    if (role < ValueRole)
+        return QIdentityProxyModel::data(index, role);
+
+    if (!index.isValid() || !m_tessellation)
+        return QVariant();
+
+    const H3Index cell = m_tessellation->cellAt(index.row());
+    if (cell == 0)
+        return QVariant();
+
+    if (m_layer->timeBucketCount() > 0)
+    {
+        ensureSlots();
+        if (static_cast<size_t>(index.row()) >= m_values.size())
+            return QVariant();
+
+        const float value = m_values[index.row()];
+        switch (role)
+        {
+        case ValueRole:
+            return std::isnan(value) ? QVariant() : QVariant(static_cast<double>(value));
+        case HasValueRole:
+            return !std::isnan(value);
+        case ColorRole:
+            return QColor::fromRgba(m_colors[index.row()]);
+        default:
+            return QVariant();
+        }
+    }
+
+    switch (role)
+    {
+    case ValueRole:
+        return m_layer->value(cell);
+    case HasValueRole:
+        return m_layer->hasValue(cell);
+    case ColorRole:
+        return m_layer->colorFor(cell);
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> H3LayerModel::roleNames() const
+{
+    QHash<int, QByteArray> roles = QIdentityProxyModel::roleNames();
+    roles[ValueRole] = "value";
+    roles[HasValueRole] = "hasValue";
+    roles[ColorRole] = "fillColor";
+    return roles;
+}
+
+void H3LayerModel::onValueChanged(const H3Index index)
+{
+    if (!m_tessellation)
+        return;
+
+    // Ячейка вне текущего viewport - обновлять нечего
+    const int row = m_tessellation->rowOf(index);
+    if (row < 0)
+        return;
+
+    const QModelIndex changed = this->index(row, 0);
+    emit dataChanged(changed, changed, {ValueRole, HasValueRole, ColorRole});
+
+    if (const int western = m_tessellation->westernRowOf(index); western >= 0)
+    {
+        const QModelIndex part = this->index(western, 0);
+        emit dataChanged(part, part, {ValueRole, HasValueRole, ColorRole});
+    }
+}
+
+void H3LayerModel::onValuesChanged(const QList<H3Index>& indices)
+{
+    if (!m_tessellation || rowCount() == 0)
+        return;
+
+    // Пакет - один dataChanged от первой до последней видимой изменённой строки
+    int first = std::numeric_limits<int>::max();
+    int last = -1;
+    const auto include = [&first, &last](const int row)
+    {
+        if (row < 0)
+            return;
+        first = std::min(first, row);
+        last = std::max(last, row);
+    };
+    for (const H3Index index : indices)
+    {
+        include(m_tessellation->rowOf(index));
+        include(m_tessellation->westernRowOf(index));
+    }
+    if (last < 0)
+        return;
+
+    emit dataChanged(index(first, 0), index(last, 0), {ValueRole, HasValueRole, ColorRole});
+}
+
+void H3LayerModel::scheduleRefresh()
+{
+    // Ряды грузятся поячеечно, пересчёт откладываем до возврата в цикл событий.
+    // Слоты могли измениться, перечитываем их
+    m_slotsDirty = true;
+    if (m_refreshPending)
+        return;
+
+    m_refreshPending = true;
+    QMetaObject::invokeMethod(this, [this]()
+    {
+        m_refreshPending = false;
+        refreshColors();
+    }, Qt::QueuedConnection);
+}
+
+void H3LayerModel::refreshColors()
+{
+    if (rowCount() == 0)
+        return;
+
+    if (m_layer->timeBucketCount() > 0)
+    {
+        // Значения текущей корзины те же, меняется только шкала
+        if (m_slotsDirty)
+            ensureSlots();
+        else
+            m_layer->rampColors(m_values, m_colors);
+    }
+
+    // Только роли слоя: геометрия делегатов остаётся прежней
+    emit dataChanged(index(0, 0), index(rowCount() - 1, 0), {ValueRole, HasValueRole, ColorRole});
+}
+
+void H3LayerModel::ensureSlots() const
+{
+    if (!m_slotsDirty)
+        return;
+
+    std::vector<H3Index> cells(rowCount());
+    for (size_t row = 0; row < cells.size(); ++row)
+        cells[row] = m_tessellation ? m_tessellation->cellAt(static_cast<int>(row)) : 0;
+
+    m_layer->dataManager()->seriesSlots(cells, m_slots);
+    m_slotsDirty = false;
+    sampleCurrentTime();
+}
+
+void H3LayerModel::sampleCurrentTime() const
+{
+    // Выборка корзины и раскраска - два линейных прохода по видимым строкам
+    m_layer->dataManager()->sampleTimeBucket(m_slots, m_currentTime, m_values);
+    m_layer->rampColors(m_values, m_colors);
+}
@@ -0,0 +1,151 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3LAYER_H
+#define H3LAYER_H
+
+#include <QColor>
+#include <QIdentityProxyModel>
+#include <QJSValue>
+#include <QObject>
+#include <QPointer>
+#include <QVariantList>
+
+#include <h3api.h>
+
+#include <vector>
+
+#include "h3ColorRamp.h"
+#include "h3datamanager.h"
+#include "h3model.h"
+
+// Слой данных: своя колонка значений, цветовая шкала и видимость поверх общей тесселяции
+class H3Layer : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(bool visible READ isVisible WRITE setVisible NOTIFY visibleChanged)
+    Q_PROPERTY(double opacity READ opacity WRITE setOpacity NOTIFY opacityChanged)
+    Q_PROPERTY(double minValue READ minValue WRITE setMinValue NOTIFY rampChanged)
+    Q_PROPERTY(double maxValue READ maxValue WRITE setMaxValue NOTIFY rampChanged)
+    Q_PROPERTY(QVariantList colorRamp READ colorRamp WRITE setColorRamp NOTIFY rampChanged)
+    Q_PROPERTY(QColor noDataColor READ noDataColor WRITE setNoDataColor NOTIFY rampChanged)
+    Q_PROPERTY(H3DataManager *dataManager READ dataManager CONSTANT)
+    Q_PROPERTY(int timeBucketCount READ timeBucketCount NOTIFY timeSeriesChanged)
+
+public:
+    explicit H3Layer(const QString &name, QObject *parent = nullptr);
+
+    QString name() const { return m_name; }
+
+    bool isVisible() const { return m_visible; }
+    void setVisible(bool visible);
+
+    double opacity() const { return m_opacity; }
+    void setOpacity(double opacity);
+
+    double minValue() const { return m_ramp.minValue(); }
+    void setMinValue(double value);
+
+    double maxValue() const { return m_ramp.maxValue(); }
+    void setMaxValue(double value);
+
+    // Равномерно распределённые опорные цвета шкалы от minValue до maxValue
+    QVariantList colorRamp() const;
+    void setColorRamp(const QVariantList &colors);
+
+    QColor noDataColor() const { return m_ramp.noDataColor(); }
+    void setNoDataColor(const QColor &color);
+
+    H3DataManager *dataManager() const { return m_dataManager; }
+    // Шкала целиком, для генераторов тайлов
+    const H3ColorRamp &ramp() const { return m_ramp; }
+
+    Q_INVOKABLE void setValue(const QString &h3Index, double value);
+    // Ряд значений по временным корзинам; первый ряд задаёт число корзин слоя
+    Q_INVOKABLE void setTimeSeries(const QString &h3Index, const QVariantList &values);
+    Q_INVOKABLE void clear();
+
+    // Пакетная запись из типизированных массивов JS: индексы - пара Uint32Array (старшие и младшие слова),
+    // значения - Float32Array или Float64Array. Один проход и один сигнал на пакет, возвращает число ячеек
+    Q_INVOKABLE int setValuesFromArrays(const QJSValue &indexHigh, const QJSValue &indexLow, const QJSValue &values);
+    // То же для рядов: по bucketCount значений на ячейку подряд
+    Q_INVOKABLE int setTimeSeriesFromArrays(const QJSValue &indexHigh, const QJSValue &indexLow,
+                                            const QJSValue &values, int bucketCount);
+
+    int timeBucketCount() const { return m_dataManager->timeBucketCount(); }
+
+    bool hasValue(H3Index index) const;
+    double value(H3Index index) const;
+    QColor colorFor(H3Index index) const;
+    QColor rampColor(double value) const;
+    // Цвета для массива значений за один проход через таблицу шкалы; NaN даёт noDataColor
+    void rampColors(const std::vector<float> &values, std::vector<QRgb> &colors) const;
+
+signals:
+    void visibleChanged();
+    void opacityChanged();
+    void rampChanged();
+    void valueChanged(H3Index index);
+    void valuesChanged(const QList<H3Index> &indices);
+    void valuesReset();
+    void timeSeriesChanged();
+
+private:
+    QString m_name;
+    bool m_visible{true};
+    double m_opacity{0.5};
+    H3ColorRamp m_ramp;
+    H3DataManager *m_dataManager;
+};
+
+// Представление общей модели ячеек для одного слоя: геометрия берётся из H3HexagonModel как есть,
+// сверху добавляются значение и цвет. Смена видимости или шкалы не пересчитывает ячейки.
+// Для временных рядов значения и цвета текущей корзины кешируются построчно
+class H3LayerModel : public QIdentityProxyModel {
+    Q_OBJECT
+    Q_PROPERTY(H3Layer *layer READ layer CONSTANT)
+    Q_PROPERTY(int currentTime READ currentTime WRITE setCurrentTime NOTIFY currentTimeChanged)
+
+public:
+    enum LayerRoles {
+        ValueRole = Qt::UserRole + 100,
+        HasValueRole,
+        ColorRole
+    };
+
+    H3LayerModel(H3HexagonModel *tessellation, H3Layer *layer, QObject *parent = nullptr);
+
+    H3Layer *layer() const { return m_layer; }
+
+    int currentTime() const { return m_currentTime; }
+    // Шаг по времени: один dataChanged по ролям цвета, без сброса модели
+    void setCurrentTime(int bucket);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+signals:
+    void currentTimeChanged();
+
+private:
+    void onValueChanged(H3Index index);
+    void onValuesChanged(const QList<H3Index> &indices);
+    void scheduleRefresh();
+    void refreshColors();
+    void ensureSlots() const;
+    void sampleCurrentTime() const;
+
+    QPointer<H3HexagonModel> m_tessellation;
+    H3Layer *m_layer;
+    int m_currentTime{0};
+    bool m_refreshPending{false};
+
+    // Кеш временного ряда по строкам модели, слоты сбрасываются вместе с тесселяцией
+    mutable bool m_slotsDirty{true};
+    mutable std::vector<int> m_slots;
+    mutable std::vector<float> m_values;
+    mutable std::vector<QRgb> m_colors;
+};
+
+#endif //H3LAYER_H
@@ -0,0 +1,237 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3layermanager.h"
+
+#include <algorithm>
+
+H3LayerManager::H3LayerManager(QObject* parent) : QAbstractListModel(parent)
+{
+    m_playbackTimer.setInterval(500);
+    connect(&m_playbackTimer, &QTimer::timeout, this, [this]() { step(1); });
+}
+
+int H3LayerManager::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return count();
+}
+
+QVariant H3LayerManager::data(const QModelIndex& index, const int role) const
+{
+    if (!index.isValid() || index.row() >= count())
+        return QVariant();
+
+    const Entry& entry = m_layers[index.row()];
+
+    switch (role)
+    {
+    case NameRole:
+        return entry.layer->name();
+    case VisibleRole:
+        return entry.layer->isVisible();
+    case LayerRole:
+        return QVariant::fromValue(entry.layer);
+    case LayerModelRole:
+        return QVariant::fromValue(entry.model);
+    default:
+        return QVariant();
+    }
+}
+
+bool H3LayerManager::setData(const QModelIndex& index, const QVariant& value, const int role)
+{
+    if (!index.isValid() || index.row() >= count() || role != VisibleRole)
+        return false;
+
+    // dataChanged придёт из onLayerVisibleChanged
+    m_layers[index.row()].layer->setVisible(value.toBool());
+    return true;
+}
+
+QHash<int, QByteArray> H3LayerManager::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[NameRole] = "name";
+    roles[VisibleRole] = "layerVisible";
+    roles[LayerRole] = "dataLayer";
+    roles[LayerModelRole] = "layerModel";
+    return roles;
+}
+
+void H3LayerManager::setTessellation(H3HexagonModel* tessellation)
+{
+    if (m_tessellation == tessellation)
+        return;
+
+    beginResetModel();
+    m_tessellation = tessellation;
+    // Представления привязаны к модели ячеек, пересоздаём их для новой
+    for (Entry& entry : m_layers)
+    {
+        delete entry.model;
+        entry.model = new H3LayerModel(m_tessellation, entry.layer, this);
+        entry.model->setCurrentTime(m_currentTime);
+    }
+    endResetModel();
+
+    emit tessellationChanged();
+}
+
+H3Layer* H3LayerManager::addLayer(const QString& name, const QVariantList& colorRamp)
+{
+    if (H3Layer* existing = layer(name))
+        return existing;
+
+    auto* layer = new H3Layer(name, this);
+    if (!colorRamp.isEmpty())
+        layer->setColorRamp(colorRamp);
+
+    connect(layer, &H3Layer::visibleChanged, this, [this, layer]() { onLayerVisibleChanged(layer); });
+    connect(layer, &H3Layer::timeSeriesChanged, this, &H3LayerManager::updateTimeBucketCount);
+
+    auto* model = new H3LayerModel(m_tessellation, layer, this);
+    model->setCurrentTime(m_currentTime);
+
+    const int row = count();
+    beginInsertRows(QModelIndex(), row, row);
+    m_layers.push_back({layer, model});
+    endInsertRows();
+
+    emit countChanged();
+    if (!m_activeLayer)
+        setActiveLayer(layer);
+    return layer;
+}
+
+bool H3LayerManager::removeLayer(const QString& name)
+{
+    const int row = indexOf(name);
+    if (row < 0)
+        return false;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    const Entry entry = m_layers[row];
+    m_layers.erase(m_layers.begin() + row);
+    endRemoveRows();
+
+    // Подписчики отпускают данные слоя до его удаления
+    if (m_activeLayer == entry.layer)
+        setActiveLayer(m_layers.empty() ? nullptr : m_layers.back().layer);
+
+    // Делегаты могут ещё держать ссылки до конца текущего события
+    entry.model->deleteLater();
+    entry.layer->deleteLater();
+    entry.layer->disconnect(this);
+
+    emit countChanged();
+    updateTimeBucketCount();
+    return true;
+}
+
+void H3LayerManager::setActiveLayer(H3Layer* layer)
+{
+    // Активным может быть только слой этого менеджера
+    if (m_activeLayer == layer || (layer && indexOf(layer->name()) < 0))
+        return;
+
+    m_activeLayer = layer;
+    emit activeLayerChanged();
+}
+
+void H3LayerManager::setCurrentTime(const int bucket)
+{
+    const int clamped = m_timeBucketCount > 0 ? std::clamp(bucket, 0, m_timeBucketCount - 1) : 0;
+    if (m_currentTime == clamped)
+        return;
+
+    m_currentTime = clamped;
+    for (const Entry& entry : m_layers)
+        entry.model->setCurrentTime(m_currentTime);
+
+    emit currentTimeChanged();
+}
+
+void H3LayerManager::setPlaybackInterval(const int interval)
+{
+    if (interval <= 0 || m_playbackTimer.interval() == interval)
+        return;
+
+    m_playbackTimer.setInterval(interval);
+    emit playbackIntervalChanged();
+}
+
+void H3LayerManager::play()
+{
+    if (m_playbackTimer.isActive() || m_timeBucketCount < 2)
+        return;
+
+    m_playbackTimer.start();
+    emit playingChanged();
+}
+
+void H3LayerManager::pause()
+{
+    if (!m_playbackTimer.isActive())
+        return;
+
+    m_playbackTimer.stop();
+    emit playingChanged();
+}
+
+void H3LayerManager::step(const int delta)
+{
+    if (m_timeBucketCount == 0)
+        return;
+
+    const int next = ((m_currentTime + delta) % m_timeBucketCount + m_timeBucketCount) % m_timeBucketCount;
+    setCurrentTime(next);
+}
+
+H3Layer* H3LayerManager::layer(const QString& name) const
+{
+    const int row = indexOf(name);
+    return row >= 0 ? m_layers[row].layer : nullptr;
+}
+
+int H3LayerManager::indexOf(const QString& name) const
+{
+    for (size_t i = 0; i < m_layers.size(); ++i)
+    {
+        if (m_layers[i].layer->name() == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void H3LayerManager::updateTimeBucketCount()
+{
+    int buckets = 0;
+    for (const Entry& entry : m_layers)
+        buckets = std::max(buckets, entry.layer->timeBucketCount());
+
+    if (m_timeBucketCount == buckets)
+        return;
+
+    m_timeBucketCount = buckets;
+    emit timeBucketCountChanged();
+
+    if (m_timeBucketCount < 2)
+        pause();
+    if (m_currentTime >= m_timeBucketCount)
+        setCurrentTime(m_timeBucketCount - 1);
+}
+
+void H3LayerManager::onLayerVisibleChanged(H3Layer* layer)
+{
+    for (size_t i = 0; i < m_layers.size(); ++i)
+    {
+        if (m_layers[i].layer == layer)
+        {
+            const QModelIndex changed = index(static_cast<int>(i), 0);
+            emit dataChanged(changed, changed, {VisibleRole});
+            return;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3LAYERMANAGER_H
+#define H3LAYERMANAGER_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QTimer>
+
+#include <vector>
+
+#include "h3layer.h"
+
+// Набор слоёв данных над одной тесселяцией viewport. Ячейки и их контуры считает H3HexagonModel,
+// слои добавляют только свои значения, цвета и видимость
+class H3LayerManager : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(H3HexagonModel *tessellation READ tessellation WRITE setTessellation NOTIFY tessellationChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(H3Layer *activeLayer READ activeLayer WRITE setActiveLayer NOTIFY activeLayerChanged)
+    Q_PROPERTY(int currentTime READ currentTime WRITE setCurrentTime NOTIFY currentTimeChanged)
+    Q_PROPERTY(int timeBucketCount READ timeBucketCount NOTIFY timeBucketCountChanged)
+    Q_PROPERTY(bool playing READ isPlaying NOTIFY playingChanged)
+    Q_PROPERTY(int playbackInterval READ playbackInterval WRITE setPlaybackInterval NOTIFY playbackIntervalChanged)
+
+public:
+    enum LayerManagerRoles {
+        NameRole = Qt::UserRole + 1,
+        VisibleRole,
+        LayerRole,
+        LayerModelRole
+    };
+
+    explicit H3LayerManager(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    H3HexagonModel *tessellation() const { return m_tessellation; }
+    void setTessellation(H3HexagonModel *tessellation);
+
+    int count() const { return static_cast<int>(m_layers.size()); }
+
+    // Слой, значения которого рисуют тайловые оверлеи MapLibre. Первый добавленный слой становится
+    // активным сам, при удалении активного его место занимает последний оставшийся
+    H3Layer *activeLayer() const { return m_activeLayer; }
+    void setActiveLayer(H3Layer *layer);
+
+    // Текущая временная корзина, общая для всех слоёв
+    int currentTime() const { return m_currentTime; }
+    void setCurrentTime(int bucket);
+
+    // Наибольшее число корзин среди слоёв
+    int timeBucketCount() const { return m_timeBucketCount; }
+
+    bool isPlaying() const { return m_playbackTimer.isActive(); }
+
+    // Интервал между шагами воспроизведения, мс
+    int playbackInterval() const { return m_playbackTimer.interval(); }
+    void setPlaybackInterval(int interval);
+
+    Q_INVOKABLE void play();
+    Q_INVOKABLE void pause();
+    // Шаг вперёд/назад с переходом через край
+    Q_INVOKABLE void step(int delta = 1);
+
+    // Повторное добавление слоя с тем же именем возвращает существующий
+    Q_INVOKABLE H3Layer *addLayer(const QString &name, const QVariantList &colorRamp = {});
+    Q_INVOKABLE bool removeLayer(const QString &name);
+    Q_INVOKABLE H3Layer *layer(const QString &name) const;
+
+signals:
+    void tessellationChanged();
+    void countChanged();
+    void activeLayerChanged();
+    void currentTimeChanged();
+    void timeBucketCountChanged();
+    void playingChanged();
+    void playbackIntervalChanged();
+
+private:
+    struct Entry {
+        H3Layer *layer;
+        H3LayerModel *model;
+    };
+
+    int indexOf(const QString &name) const;
+    void onLayerVisibleChanged(H3Layer *layer);
+    void updateTimeBucketCount();
+
+    QPointer<H3HexagonModel> m_tessellation;
+    std::vector<Entry> m_layers;
+    H3Layer *m_activeLayer{nullptr};
+    int m_currentTime{0};
+    int m_timeBucketCount{0};
+    QTimer m_playbackTimer;
+};
+
+#endif //H3LAYERMANAGER_H
@@ -1,72 +1,153 @@
 #include "h3model.h"
 
-#include <QtConcurrent/QtConcurrent>
-#include <QDebug>
+#include <QFutureWatcher>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+
+#include "instrumentation.h"
 
 const std::map<int, int> H3HexagonModel::ZOOM_TO_H3_RES = {
     {4, 1},  {5, 1},  {6, 2},   {7, 3},   {8, 3},   {9, 4},   {10, 5},  {11, 6},  {12, 6},  {13, 7},
     {14, 8}, {15, 9}, {16, 9}, {17, 10}, {18, 10}, {19, 11}, {20, 11}, {21, 12}, {22, 13}, {23, 14}, {24, 15}};
 
+namespace
+{
+    // Значение роли строится один раз, дальше отдаётся копия (разделяемые данные, без аллокаций)
+    template <typename Build>
+    const QVariant& cachedRole(QVariant& value, Build build)
+    {
+        if (!value.isValid())
+            value = build();
+        return value;
+    }
+} // namespace
+
 H3Hexagon::H3Hexagon(const H3Index idx) : index(idx)
 {
+    // Центр крупной ячейки берём из готовой таблицы
+    if (const H3CoarseGeometry::Cell* coarse = H3CoarseGeometry::find(index))
+    {
+        center = QGeoCoordinate(coarse->lat, coarse->lng);
+        return;
+    }
+
     // Получаем центр гексагона
     LatLng centerLatLng;
     cellToLatLng(index, &centerLatLng);
     center = QGeoCoordinate(radsToDegs(centerLatLng.lat), radsToDegs(centerLatLng.lng));
-
-    // Получаем границы гексагона
-    CellBoundary cellBoundary;
-    cellToBoundary(index, &cellBoundary);
-
-    for (int i = 0; i < cellBoundary.numVerts; i++)
-    {
-        boundary.append(QGeoCoordinate(radsToDegs(cellBoundary.verts[i].lat), radsToDegs(cellBoundary.verts[i].lng)));
-    }
-    // Замыкаем полигон
-    if (!boundary.isEmpty())
-    {
-        boundary.append(boundary.first());
-    }
 }
 
-H3HexagonModel::H3HexagonModel(QObject* parent) : QAbstractListModel(parent), m_zoom(5.0), m_h3Resolution(1) {}
+H3HexagonModel::H3HexagonModel(QObject* parent) : QAbstractListModel(parent), m_zoom(5.0), m_h3Resolution(1)
+{
+    m_outlineCache.setMaxCost(32); // Храним контуры для последних 32 наборов
+}
 
 int H3HexagonModel::rowCount(const QModelIndex& parent) const
 {
     Q_UNUSED(parent);
-    return m_hexagons.size();
+    return m_outlineMode ? m_outlines.size() : m_hexagons.size() + m_westernRows.size();
 }
 
 QVariant H3HexagonModel::data(const QModelIndex& index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_hexagons.size())
+    if (m_outlineMode)
+        return index.isValid() ? outlineData(index.row(), role) : QVariant();
+
+    if (!index.isValid() || index.row() >= rowCount())
         return QVariant();
 
-    const H3Hexagon& hexagon = m_hexagons[index.row()];
+    // Дополнительные строки после ячеек - западные части ячеек через антимеридиан
+    const size_t row = index.row();
+    const bool western = row >= m_hexagons.size();
+    const size_t cellRow = western ? m_westernRows[row - m_hexagons.size()] : row;
+    const H3Hexagon& hexagon = m_hexagons[cellRow];
 
     switch (role)
     {
     case IndexRole:
-        return QString::number(hexagon.index, 16);
+        return cachedRole(hexagon.indexValue, [&hexagon] { return QString::number(hexagon.index, 16); });
     case CenterRole:
-        return QVariant::fromValue(hexagon.center);
+        return cachedRole(hexagon.centerValue, [&hexagon] { return QVariant::fromValue(hexagon.center); });
     case BoundaryRole:
+        if (western)
         {
-            QVariantList boundary;
-            for (const auto& coord : hexagon.boundary)
-            {
-                boundary.append(QVariant::fromValue(coord));
-            }
-            return boundary;
+            return cachedRole(hexagon.westernBoundaryValue,
+                              [&hexagon] { return coarseBoundary(*H3CoarseGeometry::find(hexagon.index), true); });
         }
+        return cachedRole(hexagon.boundaryValue,
+                          [this, &hexagon, cellRow]
+                          {
+                              if (const H3CoarseGeometry::Cell* coarse = H3CoarseGeometry::find(hexagon.index))
+                                  return coarseBoundary(*coarse, false);
+
+                              const std::span<const uint32_t> ring = m_mesh.cellRing(cellRow);
+                              const std::vector<H3TopologyMesh::Vertex>& vertices = m_mesh.vertices();
+                              QVariantList boundary;
+                              boundary.reserve(ring.size() + 1);
+                              for (const uint32_t vertex : ring)
+                              {
+                                  boundary.append(QVariant::fromValue(
+                                      QGeoCoordinate(vertices[vertex].latitude, vertices[vertex].longitude)));
+                              }
+                              // Замыкаем полигон
+                              if (!boundary.isEmpty())
+                              {
+                                  boundary.append(boundary.first());
+                              }
+                              return boundary;
+                          });
     case PropertiesRole:
-        return hexagon.properties;
+        return cachedRole(hexagon.propertiesValue, [&hexagon] { return hexagon.properties; });
     default:
         return QVariant();
     }
 }
 
+QVariantList H3HexagonModel::coarseBoundary(const H3CoarseGeometry::Cell& cell, const bool western)
+{
+    // QGeoCoordinate не принимает развёрнутые долготы: разрезанная ячейка рисуется двумя полигонами,
+    // у контура вокруг полюса долготы возвращаются в [-180, 180]
+    std::span<const H3CoarseGeometry::Point> points = H3CoarseGeometry::boundary(cell);
+    if (H3CoarseGeometry::crossesAntimeridian(cell))
+        points = western ? H3CoarseGeometry::westernPart(cell) : H3CoarseGeometry::easternPart(cell);
+
+    QVariantList boundary;
+    boundary.reserve(points.size() + 1);
+    for (const H3CoarseGeometry::Point& point : points)
+        boundary.append(QVariant::fromValue(QGeoCoordinate(point.lat, std::remainder(point.lng, 360.0))));
+    if (!boundary.isEmpty())
+        boundary.append(boundary.first());
+    return boundary;
+}
+
+H3Index H3HexagonModel::cellAt(int row) const
+{
+    if (m_outlineMode || row < 0 || row >= rowCount())
+        return 0;
+    if (static_cast<size_t>(row) >= m_hexagons.size())
+        return m_hexagons[m_westernRows[row - m_hexagons.size()]].index;
+    return m_hexagons[row].index;
+}
+
+int H3HexagonModel::rowOf(H3Index index) const
+{
+    if (m_outlineMode)
+        return -1;
+    const auto it = m_indexMap.find(index);
+    return it != m_indexMap.end() ? static_cast<int>(it->second) : -1;
+}
+
+int H3HexagonModel::westernRowOf(const H3Index index) const
+{
+    // Разрезанных ячеек единицы и только на крупных разрешениях - линейного поиска хватает
+    if (m_outlineMode || m_westernRows.empty())
+        return -1;
+    const int row = rowOf(index);
+    const auto it = std::find(m_westernRows.begin(), m_westernRows.end(), static_cast<size_t>(row));
+    return it != m_westernRows.end() ? static_cast<int>(m_hexagons.size() + (it - m_westernRows.begin())) : -1;
+}
+
 QHash<int, QByteArray> H3HexagonModel::roleNames() const
 {
     QHash<int, QByteArray> roles;
@@ -74,6 +155,7 @@ QHash<int, QByteArray> H3HexagonModel::roleNames() const
     roles[CenterRole] = "center";
     roles[BoundaryRole] = "boundary";
     roles[PropertiesRole] = "properties";
+    roles[HolesRole] = "holes";
     return roles;
 }
 
@@ -99,6 +181,27 @@ void H3HexagonModel::setViewport(const QGeoRectangle& viewport)
         return;
 
     m_viewport = viewport;
+    m_viewportRing = ViewportGeometry::fromRectangle(viewport);
+    emit viewportChanged();
+
+    updateHexagons();
+}
+
+void H3HexagonModel::setViewportCorners(const QVariantList& corners, const double margin)
+{
+    QList<QGeoCoordinate> coordinates;
+    coordinates.reserve(corners.size());
+    for (const QVariant& corner : corners)
+    {
+        coordinates.append(corner.value<QGeoCoordinate>());
+    }
+
+    const ViewportGeometry::GeoRing ring = ViewportGeometry::expanded(ViewportGeometry::fromCorners(coordinates), margin);
+    if (ring.size() < 3)
+        return;
+
+    m_viewportRing = ring;
+    m_viewport = ViewportGeometry::boundingRectangle(ring);
     emit viewportChanged();
 
     updateHexagons();
@@ -121,15 +224,74 @@ auto H3HexagonModel::setViewportFromCenter(const QGeoCoordinate& center, const d
     setViewport(newViewport);
 }
 
+void H3HexagonModel::setOutlineMode(const bool enabled)
+{
+    if (m_outlineMode == enabled)
+        return;
+
+    beginResetModel();
+    m_outlineMode = enabled;
+    m_outlines.clear();
+    endResetModel();
+
+    emit outlineModeChanged();
+    emit outlineCountChanged();
+
+    if (m_outlineMode)
+    {
+        requestOutlines();
+    }
+}
+
+int H3HexagonModel::setOutlineCells(const QStringList& cells)
+{
+    std::vector<H3Index> parsed;
+    parsed.reserve(cells.size());
+    int resolution = -1;
+    for (const QString& cell : cells)
+    {
+        const H3Index index = cell.toULongLong(nullptr, 16);
+        if (!isValidCell(index))
+            continue;
+
+        // Объединённый контур H3 строит только по ячейкам одного разрешения
+        if (resolution < 0)
+            resolution = getResolution(index);
+        if (getResolution(index) != resolution)
+        {
+            H3_LOG_WARN("outline cells must share one resolution: {} and {}", resolution, getResolution(index));
+            return 0;
+        }
+        parsed.push_back(index);
+    }
+
+    std::sort(parsed.begin(), parsed.end());
+    parsed.erase(std::unique(parsed.begin(), parsed.end()), parsed.end());
+    if (parsed.size() > static_cast<size_t>(kMaxOutlineCells))
+    {
+        H3_LOG_WARN("too many outline cells: {} > {}", parsed.size(), kMaxOutlineCells);
+        return 0;
+    }
+
+    m_outlineCells = std::move(parsed);
+    if (m_outlineMode)
+        requestOutlines();
+    return static_cast<int>(m_outlineCells.size());
+}
+
 void H3HexagonModel::setHexagonProperty(const QString& h3IndexStr, const QString& key, const QVariant& value)
 {
     const H3Index h3Index = std::stoull(h3IndexStr.toStdString(), nullptr, 16);
 
     if (const auto it = m_indexMap.find(h3Index); it != m_indexMap.end())
     {
-        m_hexagons[it->second].properties[key] = value;
+        H3Hexagon& hexagon = m_hexagons[it->second];
+        hexagon.properties[key] = value;
+        hexagon.propertiesValue = QVariant();
         const QModelIndex modelIndex = index(it->second);
         emit dataChanged(modelIndex, modelIndex, {PropertiesRole});
+        if (const int western = westernRowOf(h3Index); western >= 0)
+            emit dataChanged(index(western), index(western), {PropertiesRole});
     }
 }
 
@@ -145,39 +307,172 @@ QVariant H3HexagonModel::getHexagonProperty(const QString& h3IndexStr, const QSt
 
 void H3HexagonModel::updateHexagons()
 {
+    ++m_updateGeneration; // Синхронное обновление делает устаревшим любой асинхронный расчёт
+    m_cancelToken.cancel();
+
     emit updateStarted();
 
-    beginResetModel();
+    H3_COUNTER_ADD(Updates, 1);
+    H3_LOG_DEBUG("updating hexagons: vertices={} resolution={}", m_viewportRing.size(), m_h3Resolution);
+
+    // Полигоны и границы считаем до сброса модели, чтобы QML не ждал их внутри reset
+    applyHexagons(computeHexagons(m_viewportRing, m_h3Resolution, CancellationToken()));
+}
+
+quint64 H3HexagonModel::updateViewportAsync(const ViewportGeometry::GeoRing& viewport, const double zoom,
+                                            const int resolution)
+{
+    if (!qFuzzyCompare(m_zoom, zoom))
+    {
+        m_zoom = zoom;
+        emit zoomChanged();
+    }
+
+    if (resolution != m_h3Resolution)
+    {
+        m_h3Resolution = resolution;
+        emit h3ResolutionChanged();
+    }
+
+    m_viewportRing = viewport;
+    if (const QGeoRectangle bounds = ViewportGeometry::boundingRectangle(viewport); m_viewport != bounds)
+    {
+        m_viewport = bounds;
+        emit viewportChanged();
+    }
+
+    // Предыдущий расчёт больше не нужен - просим его остановиться
+    m_cancelToken.cancel();
+    m_cancelToken = CancellationToken();
+
+    const quint64 generation = ++m_updateGeneration;
 
-    m_hexagons.clear();
-    m_indexMap.clear();
+    emit updateStarted();
+    H3_COUNTER_ADD(Updates, 1);
 
-    qDebug() << "Updating hexagons - Viewport valid:" << m_viewport.isValid() << "TopLeft:" << m_viewport.topLeft()
-             << "BottomRight:" << m_viewport.bottomRight() << "Resolution:" << m_h3Resolution;
+    auto* watcher = new QFutureWatcher<HexagonSet>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this,
+            [this, watcher, generation]()
+            {
+                watcher->deleteLater();
+                // Отменённая до старта задача завершает future без результата
+                if (generation != m_updateGeneration || watcher->future().resultCount() == 0)
+                {
+                    emit updateCancelled();
+                    return;
+                }
+                applyHexagons(watcher->future().takeResult());
+            });
+    // Ячейки видимой области - интерактивный класс общего пула, впереди подкачки и обслуживания
+    watcher->setFuture(H3TaskScheduler::instance().run(
+        TaskPriority::Interactive, [viewport, resolution, token = m_cancelToken]()
+        { return computeHexagons(viewport, resolution, token); }, m_cancelToken));
+    return generation;
+}
 
-    if (m_viewport.isValid() && !m_viewport.isEmpty())
+H3HexagonModel::HexagonSet H3HexagonModel::computeHexagons(const ViewportGeometry::GeoRing& viewport,
+                                                           const int resolution,
+                                                           const CancellationToken& token)
+{
+    HexagonSet result;
+    if (viewport.size() < 3)
+        return result;
+
+    std::vector<H3Index> hexIndexes;
     {
-        std::vector<H3Index> hexIndexes = getHexagonsInViewport(m_viewport, m_h3Resolution);
+        H3_STAGE_TIMER(Polyfill);
+        hexIndexes = getHexagonsInViewport(viewport, resolution, &result.truncated);
+    }
 
-        qDebug() << "Got" << hexIndexes.size() << "hex indexes from H3";
+    H3_STAGE_TIMER(Boundary);
+    result.hexagons.reserve(hexIndexes.size());
+    result.indexMap.reserve(hexIndexes.size());
+    for (size_t i = 0; i < hexIndexes.size(); ++i)
+    {
+        // Проверяем отмену пачками, чтобы не платить за атомарное чтение на каждую ячейку
+        if ((i & 255) == 0 && token.isCancelled())
+            return {};
+
+        result.hexagons.emplace_back(hexIndexes[i]);
+        result.indexMap[hexIndexes[i]] = i;
 
-        m_hexagons.reserve(hexIndexes.size());
-        for (size_t i = 0; i < hexIndexes.size(); ++i)
+        if (const H3CoarseGeometry::Cell* coarse = H3CoarseGeometry::find(hexIndexes[i]);
+            coarse && H3CoarseGeometry::crossesAntimeridian(*coarse))
         {
-            m_hexagons.emplace_back(hexIndexes[i]);
-            m_indexMap[hexIndexes[i]] = i;
+            result.westernRows.push_back(i);
         }
     }
+    result.mesh.build(hexIndexes);
+    H3_COUNTER_ADD(CellsGenerated, hexIndexes.size());
+    return result;
+}
 
-    endResetModel();
+void H3HexagonModel::applyHexagons(HexagonSet&& hexagons)
+{
+    {
+        H3_STAGE_TIMER(ModelReset);
+        beginResetModel();
+        m_hexagons = std::move(hexagons.hexagons);
+        m_indexMap = std::move(hexagons.indexMap);
+        m_mesh = std::move(hexagons.mesh);
+        m_westernRows = std::move(hexagons.westernRows);
+        m_truncated = hexagons.truncated;
+        // Контур явного набора от viewport не зависит
+        if (m_outlineCells.empty())
+            m_outlines.clear();
+        endResetModel();
+    }
 
     emit hexagonCountChanged();
+
+    if (m_outlineMode && m_outlineCells.empty())
+    {
+        emit outlineCountChanged();
+        requestOutlines();
+    }
+
     emit updateFinished();
 
-    qDebug() << "Updated hexagons:" << m_hexagons.size() << "at resolution" << m_h3Resolution;
+    H3_LOG_DEBUG("updated hexagons: {} at resolution {}", m_hexagons.size(), m_h3Resolution);
+}
+
+int H3HexagonModel::zoomToH3Resolution(const double zoom)
+{
+    const double latitude = m_viewportRing.empty() ? 0.0 : ViewportGeometry::centroid(m_viewportRing).lat;
+    return selectResolution(zoom, latitude, m_devicePixelRatio, m_viewportPixels);
+}
+
+int H3HexagonModel::selectResolution(const double zoom, const double latitude, const double devicePixelRatio,
+                                     const QSizeF& viewportPixels)
+{
+    m_devicePixelRatio = devicePixelRatio;
+    m_viewportPixels = viewportPixels;
+
+    if (!m_adaptiveResolution)
+        return resolutionForZoom(zoom);
+    return m_resolutionSelector.select(zoom, latitude, devicePixelRatio, viewportPixels);
+}
+
+void H3HexagonModel::setAdaptiveResolution(const bool enabled)
+{
+    if (m_adaptiveResolution == enabled)
+        return;
+
+    m_adaptiveResolution = enabled;
+    m_resolutionSelector.reset();
+    emit adaptiveResolutionChanged();
+}
+
+void H3HexagonModel::setTargetCellSize(const double pixels)
+{
+    if (qFuzzyCompare(m_resolutionSelector.targetCellSize(), pixels))
+        return;
+
+    m_resolutionSelector.setTargetCellSize(pixels);
+    emit targetCellSizeChanged();
 }
 
-int H3HexagonModel::zoomToH3Resolution(const double zoom) const
+int H3HexagonModel::resolutionForZoom(const double zoom)
 {
     int intZoom = static_cast<int>(std::round(zoom));
 
@@ -193,54 +488,263 @@ int H3HexagonModel::zoomToH3Resolution(const double zoom) const
     return 4;
 }
 
-std::vector<H3Index> H3HexagonModel::getHexagonsInViewport(const QGeoRectangle& viewport, const int resolution) const
+std::vector<H3Index> H3HexagonModel::getHexagonsInViewport(const ViewportGeometry::GeoRing& viewport,
+                                                           const int resolution, bool* truncated)
 {
     std::vector<H3Index> result;
 
-    if (!viewport.isValid() || viewport.isEmpty())
-        return result;
-
-    // Получаем углы viewport
-    const QGeoCoordinate topLeft = viewport.topLeft();
-    const QGeoCoordinate bottomRight = viewport.bottomRight();
+    // Крупные разрешения - из готовых таблиц, без полифилла: ячейка видна, если её центр внутри области
+    if (resolution <= H3CoarseGeometry::kMaxResolution)
+    {
+        double west = std::numeric_limits<double>::max();
+        double east = std::numeric_limits<double>::lowest();
+        double south = 90.0;
+        double north = -90.0;
+        for (const ViewportGeometry::GeoPoint& point : viewport)
+        {
+            west = std::min(west, point.lng);
+            east = std::max(east, point.lng);
+            south = std::min(south, point.lat);
+            north = std::max(north, point.lat);
+        }
 
-    qDebug() << "Getting hexagons for viewport:"
-             << "TL:" << topLeft.latitude() << "," << topLeft.longitude() << "BR:" << bottomRight.latitude() << ","
-             << bottomRight.longitude() << "Resolution:" << resolution;
+        for (const H3Index cell : H3CoarseGeometry::cellsInBounds(resolution, west, south, east, north))
+        {
+            const H3CoarseGeometry::Cell* coarse = H3CoarseGeometry::find(cell);
+            for (const double shift : {0.0, -360.0, 360.0})
+            {
+                if (ViewportGeometry::contains(viewport, {coarse->lat, coarse->lng + shift}))
+                {
+                    result.push_back(cell);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
 
-    // Преобразуем в H3 GeoPolygon
-    std::vector<LatLng> verts;
-    verts.push_back({degsToRads(topLeft.latitude()), degsToRads(topLeft.longitude())});
-    verts.push_back({degsToRads(topLeft.latitude()), degsToRads(bottomRight.longitude())});
-    verts.push_back({degsToRads(bottomRight.latitude()), degsToRads(bottomRight.longitude())});
-    verts.push_back({degsToRads(bottomRight.latitude()), degsToRads(topLeft.longitude())});
+    // Через антимеридиан и на широких видах многоугольник уходит в H3 несколькими полосами
+    const std::vector<ViewportGeometry::GeoRing> pieces = ViewportGeometry::splitForPolyfill(viewport);
+    if (pieces.empty())
+        return result;
 
-    GeoPolygon polygon;
-    polygon.geoloop.verts = verts.data();
-    polygon.geoloop.numVerts = verts.size();
-    polygon.numHoles = 0;
-    polygon.holes = nullptr;
+    std::vector<std::vector<LatLng>> loops;
+    std::vector<GeoPolygon> polygons;
+    std::vector<int64_t> sizes;
+    loops.reserve(pieces.size());
+    polygons.reserve(pieces.size());
 
     // Оцениваем количество гексагонов
     int64_t numHexagons = 0;
-    auto error = maxPolygonToCellsSize(&polygon, resolution, 0, &numHexagons);
+    for (const ViewportGeometry::GeoRing& piece : pieces)
+    {
+        std::vector<LatLng>& verts = loops.emplace_back();
+        verts.reserve(piece.size());
+        for (const ViewportGeometry::GeoPoint& point : piece)
+        {
+            verts.push_back({degsToRads(point.lat), degsToRads(point.lng)});
+        }
 
-    qDebug() << "Estimated hexagons count:" << numHexagons;
+        GeoPolygon polygon;
+        polygon.geoloop.verts = verts.data();
+        polygon.geoloop.numVerts = static_cast<int>(verts.size());
+        polygon.numHoles = 0;
+        polygon.holes = nullptr;
+        polygons.push_back(polygon);
+
+        int64_t size = 0;
+        if (maxPolygonToCellsSize(&polygon, resolution, 0, &size) != E_SUCCESS)
+            size = 0;
+        sizes.push_back(size);
+        numHexagons += size;
+    }
+
+    H3_LOG_DEBUG("viewport: {} vertices, {} pieces, resolution: {}, estimated hexagons count: {}", viewport.size(),
+                 pieces.size(), resolution, numHexagons);
 
     if (numHexagons > 0 && numHexagons < 10000)
     { // Ограничение для производительности
-        result.resize(numHexagons);
-        polygonToCells(&polygon, resolution, 0, result.data());
+        result.resize(numHexagons, 0);
+        size_t offset = 0;
+        for (size_t i = 0; i < polygons.size(); ++i)
+        {
+            if (sizes[i] > 0 && polygonToCells(&polygons[i], resolution, 0, result.data() + offset) == E_SUCCESS)
+                offset += sizes[i];
+        }
+        result.resize(offset);
 
         // Удаляем нулевые индексы
         std::erase(result, 0);
 
-        qDebug() << "Actual hexagons after filtering:" << result.size();
+        // Ячейки на границах полос попадают в обе
+        if (pieces.size() > 1)
+        {
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+        }
+
+        H3_LOG_DEBUG("actual hexagons after filtering: {}", result.size());
     }
     else if (numHexagons >= 10000)
     {
-        qWarning() << "Too many hexagons requested:" << numHexagons << "- limiting viewport";
+        H3_COUNTER_ADD(ViewportsRejected, 1);
+        if (truncated)
+            *truncated = true;
+        H3_LOG_WARN("too many hexagons requested: {} - limiting viewport", numHexagons);
+    }
+
+    return result;
+}
+
+QVariant H3HexagonModel::outlineData(const int row, const int role) const
+{
+    if (row < 0 || row >= m_outlines.size())
+        return QVariant();
+
+    const H3Outline& outline = m_outlines[row];
+
+    switch (role)
+    {
+    case IndexRole:
+        return QString();
+    case CenterRole:
+        return QVariant::fromValue(outline.boundary.isEmpty() ? QGeoCoordinate() : outline.boundary.first());
+    case BoundaryRole:
+        {
+            QVariantList boundary;
+            boundary.reserve(outline.boundary.size());
+            for (const auto& coord : outline.boundary)
+            {
+                boundary.append(QVariant::fromValue(coord));
+            }
+            return boundary;
+        }
+    case HolesRole:
+        return outline.holes;
+    default:
+        return QVariant();
+    }
+}
+
+void H3HexagonModel::requestOutlines()
+{
+    std::vector<H3Index> cells = m_outlineCells;
+    if (m_outlineCells.empty())
+    {
+        cells.reserve(m_hexagons.size());
+        for (const auto& hexagon : m_hexagons)
+        {
+            cells.push_back(hexagon.index);
+        }
+    }
+
+    const quint64 key = cellSetKey(cells);
+    const quint64 generation = ++m_outlineGeneration;
+    m_outlineToken.cancel();
+    m_outlineToken = CancellationToken();
+
+    // Совпадение хеша проверяем по самому набору
+    if (const H3OutlineCacheEntry* cached = m_outlineCache.object(key); cached && cached->cells == cells)
+    {
+        H3_COUNTER_ADD(OutlineCacheHits, 1);
+        applyOutlines(cached->outlines);
+        return;
+    }
+    H3_COUNTER_ADD(OutlineCacheMisses, 1);
+
+    // Построение контура для десятков тысяч ячеек заметно по времени - считаем в пуле потоков.
+    // Устаревший запрос, ещё не взятый потоком, выбрасывается по токену
+    const QFuture<QList<H3Outline>> future = H3TaskScheduler::instance().run(
+        TaskPriority::Interactive, [cells]() { return buildOutlines(cells); }, m_outlineToken);
+    auto* watcher = new QFutureWatcher<QList<H3Outline>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this,
+            [this, watcher, key, generation, cells = std::move(cells)]() mutable
+            {
+                watcher->deleteLater();
+                if (watcher->future().resultCount() == 0)
+                    return;
+                const QList<H3Outline> outlines = watcher->result();
+                m_outlineCache.insert(key, new H3OutlineCacheEntry{std::move(cells), outlines});
+
+                if (m_outlineMode && generation == m_outlineGeneration)
+                {
+                    applyOutlines(outlines);
+                }
+            });
+    watcher->setFuture(future);
+}
+
+void H3HexagonModel::applyOutlines(const QList<H3Outline>& outlines)
+{
+    beginResetModel();
+    m_outlines = outlines;
+    endResetModel();
+
+    emit outlineCountChanged();
+}
+
+quint64 H3HexagonModel::cellSetKey(std::vector<H3Index>& cells)
+{
+    // Порядок ячеек не важен - сортируем, чтобы одинаковые наборы давали одинаковый ключ
+    std::sort(cells.begin(), cells.end());
+
+    quint64 hash = 1469598103934665603ULL;
+    for (const H3Index cell : cells)
+    {
+        hash ^= cell;
+        hash *= 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    return hash ^ cells.size();
+}
+
+QList<H3Outline> H3HexagonModel::buildOutlines(std::vector<H3Index> cells)
+{
+    QList<H3Outline> result;
+
+    LinkedGeoPolygon polygon{};
+    if (cells.empty() ||
+        cellsToLinkedMultiPolygon(cells.data(), static_cast<int>(cells.size()), &polygon) != E_SUCCESS)
+    {
+        return result;
+    }
+
+    for (const LinkedGeoPolygon* part = &polygon; part; part = part->next)
+    {
+        H3Outline outline;
+
+        // Первая петля - внешняя граница, остальные - дыры
+        for (const LinkedGeoLoop* loop = part->first; loop; loop = loop->next)
+        {
+            QList<QGeoCoordinate> ring;
+            for (const LinkedLatLng* vertex = loop->first; vertex; vertex = vertex->next)
+            {
+                ring.append(QGeoCoordinate(radsToDegs(vertex->vertex.lat), radsToDegs(vertex->vertex.lng)));
+            }
+            if (!ring.isEmpty())
+            {
+                ring.append(ring.first());
+            }
+
+            if (loop == part->first)
+            {
+                outline.boundary = std::move(ring);
+            }
+            else
+            {
+                QVariantList hole;
+                hole.reserve(ring.size());
+                for (const auto& coord : ring)
+                {
+                    hole.append(QVariant::fromValue(coord));
+                }
+                outline.holes.append(QVariant(hole));
+            }
+        }
+
+        result.append(std::move(outline));
     }
 
+    destroyLinkedMultiPolygon(&polygon);
     return result;
 }
@@ -7,35 +7,70 @@
 
 #include <QAbstractListModel>
 
+#include <QCache>
 #include <QGeoCoordinate>
 #include <QGeoRectangle>
+#include <QSizeF>
 #include <h3api.h>
 
+#include "h3CoarseGeometry.h"
+#include "h3FlatMap.h"
+#include "h3TaskScheduler.h"
+#include "h3TopologyMesh.h"
+#include "resolutionSelector.h"
+#include "viewportGeometry.h"
+
 
 class H3Hexagon {
 public:
     H3Index index;
     QGeoCoordinate center;
-    QList<QGeoCoordinate> boundary;
     QVariantMap properties; // Для хранения дополнительных данных
 
+    // Значения ролей для QML: собираются при первом запросе, сбрасываются при изменении данных ячейки
+    mutable QVariant indexValue;
+    mutable QVariant centerValue;
+    mutable QVariant boundaryValue;
+    mutable QVariant westernBoundaryValue; // Только у ячеек, разрезанных антимеридианом
+    mutable QVariant propertiesValue;
+
     H3Hexagon() : index(0) {}
     H3Hexagon(H3Index idx);
 };
 
+// Объединённый контур набора ячеек (внешняя граница + дыры)
+struct H3Outline {
+    QList<QGeoCoordinate> boundary;
+    QList<QVariant> holes;
+};
+
+// Запись кеша контуров: набор ячеек хранится целиком, чтобы коллизия хеша не вернула чужой контур
+struct H3OutlineCacheEntry {
+    std::vector<H3Index> cells;
+    QList<H3Outline> outlines;
+};
+
 class H3HexagonModel : public QAbstractListModel {
     Q_OBJECT
     Q_PROPERTY(double zoom READ zoom WRITE setZoom NOTIFY zoomChanged)
     Q_PROPERTY(QGeoRectangle viewport READ viewport WRITE setViewport NOTIFY viewportChanged)
     Q_PROPERTY(int h3Resolution READ h3Resolution NOTIFY h3ResolutionChanged)
     Q_PROPERTY(int hexagonCount READ hexagonCount NOTIFY hexagonCountChanged)
+    Q_PROPERTY(bool outlineMode READ outlineMode WRITE setOutlineMode NOTIFY outlineModeChanged)
+    Q_PROPERTY(int outlineCount READ outlineCount NOTIFY outlineCountChanged)
+    Q_PROPERTY(bool adaptiveResolution READ adaptiveResolution WRITE setAdaptiveResolution NOTIFY
+                   adaptiveResolutionChanged)
+    Q_PROPERTY(double targetCellSize READ targetCellSize WRITE setTargetCellSize NOTIFY targetCellSizeChanged)
 
 public:
+    static constexpr int kMaxOutlineCells = 200000;
+
     enum HexagonRoles {
         IndexRole = Qt::UserRole + 1,
         CenterRole,
         BoundaryRole,
-        PropertiesRole
+        PropertiesRole,
+        HolesRole
     };
 
     explicit H3HexagonModel(QObject *parent = nullptr);
@@ -55,9 +90,50 @@ public:
     // Альтернативный метод установки viewport через центр и размеры
     Q_INVOKABLE void setViewportFromCenter(const QGeoCoordinate &center, double widthInDegrees, double heightInDegrees);
 
+    // Видимая область по углам экрана (или трапеции при наклоне) в порядке обхода; margin - доля запаса
+    Q_INVOKABLE void setViewportCorners(const QVariantList &corners, double margin = 0.0);
+
+    // Пересчёт в пуле потоков: новый запрос отменяет незавершённый, применяется только последний результат.
+    // Возвращает поколение запроса; пока updateGeneration() с ним совпадает, запрос никто не вытеснил
+    quint64 updateViewportAsync(const ViewportGeometry::GeoRing &viewport, double zoom, int resolution);
+    quint64 updateGeneration() const { return m_updateGeneration; }
+    // Последний применённый расчёт упёрся в лимит ячеек: область пуста, а не покрыта
+    bool truncated() const { return m_truncated; }
+
     int h3Resolution() const { return m_h3Resolution; }
+    static int resolutionForZoom(double zoom);
+
+    // Разрешение по экранному размеру ячейки (или по таблице ZOOM_TO_H3_RES, если adaptiveResolution выключен).
+    // Запоминает DPR и размер окна для синхронных обновлений через setZoom/setViewport
+    int selectResolution(double zoom, double latitude, double devicePixelRatio, const QSizeF &viewportPixels);
+
+    bool adaptiveResolution() const { return m_adaptiveResolution; }
+    void setAdaptiveResolution(bool enabled);
+
+    // Целевая длина ребра ячейки в физических пикселях
+    double targetCellSize() const { return m_resolutionSelector.targetCellSize(); }
+    void setTargetCellSize(double pixels);
     int hexagonCount() const { return m_hexagons.size(); }
 
+    // Доступ к общей тесселяции для слоёв данных (в режиме контуров ячеек нет). Ячейка через антимеридиан
+    // занимает две строки: восточная часть - в строке rowOf, западная - в строке westernRowOf после всех ячеек
+    H3Index cellAt(int row) const;
+    int rowOf(H3Index index) const;
+    int westernRowOf(H3Index index) const;
+
+    // Вершины и рёбра текущего набора ячеек без повторов; кольцо строки row - mesh().cellRing(row)
+    const H3TopologyMesh &mesh() const { return m_mesh; }
+
+    // Режим контуров: вместо каждой ячейки модель отдаёт объединённые полигоны набора
+    bool outlineMode() const { return m_outlineMode; }
+    void setOutlineMode(bool enabled);
+    int outlineCount() const { return m_outlines.size(); }
+
+    // Контур явного набора ячеек одного разрешения (выделение, регион) вместо ячеек viewport. Набор не
+    // ограничен лимитом viewport, но больше kMaxOutlineCells отклоняется. Пустой список - снова viewport.
+    // Возвращает число принятых ячеек
+    Q_INVOKABLE int setOutlineCells(const QStringList &cells);
+
     // Методы для работы с данными
     Q_INVOKABLE void setHexagonProperty(const QString &h3Index, const QString &key, const QVariant &value);
     Q_INVOKABLE QVariant getHexagonProperty(const QString &h3Index, const QString &key) const;
@@ -67,19 +143,63 @@ signals:
     void viewportChanged();
     void h3ResolutionChanged();
     void hexagonCountChanged();
+    void outlineModeChanged();
+    void outlineCountChanged();
     void updateStarted();
     void updateFinished();
+    void updateCancelled();
+    void adaptiveResolutionChanged();
+    void targetCellSizeChanged();
 
 private:
+    struct HexagonSet {
+        std::vector<H3Hexagon> hexagons;
+        H3FlatMap<size_t> indexMap;
+        H3TopologyMesh mesh;
+        std::vector<size_t> westernRows; // Строки ячеек, разрезанных антимеридианом
+        bool truncated{false};
+    };
+
     void updateHexagons();
-    int zoomToH3Resolution(double zoom) const;
-    std::vector<H3Index> getHexagonsInViewport(const QGeoRectangle &viewport, int resolution) const;
+    void applyHexagons(HexagonSet &&hexagons);
+    int zoomToH3Resolution(double zoom);
+    static HexagonSet computeHexagons(const ViewportGeometry::GeoRing &viewport, int resolution,
+                                      const CancellationToken &token);
+    static std::vector<H3Index> getHexagonsInViewport(const ViewportGeometry::GeoRing &viewport, int resolution,
+                                                      bool *truncated = nullptr);
+
+    // Контур крупной ячейки из таблиц, с точками искажения. У разрезанной ячейки - восточная или западная часть
+    static QVariantList coarseBoundary(const H3CoarseGeometry::Cell &cell, bool western);
+    QVariant outlineData(int row, int role) const;
+    void requestOutlines();
+    void applyOutlines(const QList<H3Outline> &outlines);
+    static quint64 cellSetKey(std::vector<H3Index> &cells);
+    static QList<H3Outline> buildOutlines(std::vector<H3Index> cells);
 
     double m_zoom;
-    QGeoRectangle m_viewport;
+    QGeoRectangle m_viewport;               // Ограничивающий прямоугольник для QML и подложки
+    ViewportGeometry::GeoRing m_viewportRing; // Что реально покрываем ячейками
     int m_h3Resolution;
     std::vector<H3Hexagon> m_hexagons;
-    std::unordered_map<H3Index, size_t> m_indexMap; // Для быстрого поиска
+    H3FlatMap<size_t> m_indexMap; // Для быстрого поиска
+    H3TopologyMesh m_mesh;        // Геометрия ячеек: общие вершины вместо копии контура в каждой
+    std::vector<size_t> m_westernRows; // Строка ячейки для каждой дополнительной строки западной части
+    bool m_truncated{false};
+
+    ResolutionSelector m_resolutionSelector;
+    bool m_adaptiveResolution{true};
+    double m_devicePixelRatio{1.0};
+    QSizeF m_viewportPixels{1920, 1080};
+
+    quint64 m_updateGeneration{0}; // Отбрасываем результаты отменённых расчётов
+    CancellationToken m_cancelToken; // Отмена текущего асинхронного расчёта
+
+    bool m_outlineMode{false};
+    QList<H3Outline> m_outlines;
+    std::vector<H3Index> m_outlineCells;            // Явный набор для контура, пустой - ячейки viewport
+    quint64 m_outlineGeneration{0};                 // Отбрасываем устаревшие асинхронные результаты
+    CancellationToken m_outlineToken;               // Отмена ещё не начатого построения контура
+    QCache<quint64, H3OutlineCacheEntry> m_outlineCache; // Ключ - хеш отсортированного набора ячеек
 
     // Маппинг zoom -> H3 resolution
     static const std::map<int, int> ZOOM_TO_H3_RES;
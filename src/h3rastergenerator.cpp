@@ -0,0 +1,387 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3rastergenerator.h"
+
+#include <QBuffer>
+#include <QColor>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineF>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "h3PackedGeometry.h"
+#include "h3TopologyMesh.h"
+#include "h3TaskScheduler.h"
+#include "h3datamanager.h"
+#include "h3model.h"
+#include "h3tilegenerator.h"
+#include "instrumentation.h"
+
+namespace
+{
+    constexpr int kCacheBytes = 32 * 1024 * 1024;
+    constexpr int kRevisionIntervalMs = 500;
+    constexpr int kMaxRingVertices = 6;
+
+    // Цвета повторяют слои h3-fill/h3-line векторных тайлов (с учётом fill-opacity)
+    const QRgb kNoDataColor = qPremultiply(qRgba(64, 128, 255, 64));
+    const QRgb kLineColor = qPremultiply(qRgba(0, 128, 255, 255));
+    constexpr int kDataAlpha = 128;
+
+    // Ближайшая к reference копия x через антимеридиан, в долях мира
+    double unwrap(const double x, const double reference)
+    {
+        if (x - reference > 0.5)
+            return x - 1.0;
+        if (x - reference < -0.5)
+            return x + 1.0;
+        return x;
+    }
+
+    struct Polygon {
+        std::array<QPointF, kMaxRingVertices> points;
+        int size;
+        double top;
+        double bottom;
+        QRgb color; // premultiplied
+    };
+
+    // Наложение source-over для premultiplied ARGB32
+    QRgb blend(const QRgb destination, const QRgb source)
+    {
+        const uint inverse = 255 - qAlpha(source);
+        const auto channel = [inverse](const uint d, const uint s) { return s + (d * inverse + 127) / 255; };
+        return qRgba(channel(qRed(destination), qRed(source)), channel(qGreen(destination), qGreen(source)),
+                     channel(qBlue(destination), qBlue(source)), channel(qAlpha(destination), qAlpha(source)));
+    }
+
+    // Заливка строк [firstRow, lastRow): пиксель закрашен, если его центр внутри многоугольника
+    void fillBand(uchar* bits, const qsizetype bytesPerLine, const std::vector<Polygon>& polygons,
+                  const int firstRow, const int lastRow)
+    {
+        constexpr int size = H3RasterTileGenerator::kTileSize;
+        std::array<double, kMaxRingVertices> crossings;
+
+        for (const Polygon& polygon : polygons)
+        {
+            const int top = std::max(firstRow, static_cast<int>(std::ceil(polygon.top - 0.5)));
+            const int bottom = std::min(lastRow, static_cast<int>(std::ceil(polygon.bottom - 0.5)));
+            for (int row = top; row < bottom; ++row)
+            {
+                const double y = row + 0.5;
+                int count = 0;
+                for (int i = 0; i < polygon.size; ++i)
+                {
+                    const QPointF& a = polygon.points[i];
+                    const QPointF& b = polygon.points[(i + 1) % polygon.size];
+                    if ((a.y() <= y) != (b.y() <= y))
+                        crossings[count++] = a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y());
+                }
+                std::sort(crossings.begin(), crossings.begin() + count);
+
+                auto* line = reinterpret_cast<QRgb*>(bits + row * bytesPerLine);
+                for (int i = 0; i + 1 < count; i += 2)
+                {
+                    const int first = std::max(0, static_cast<int>(std::ceil(crossings[i] - 0.5)));
+                    const int last = std::min(size, static_cast<int>(std::ceil(crossings[i + 1] - 0.5)));
+                    for (int column = first; column < last; ++column)
+                        line[column] = blend(line[column], polygon.color);
+                }
+            }
+        }
+    }
+
+    // Рёбра толщиной в пиксель, каждое общее ребро рисуется один раз
+    void strokeBand(uchar* bits, const qsizetype bytesPerLine, const std::vector<QLineF>& lines, const int firstRow,
+                    const int lastRow)
+    {
+        constexpr int size = H3RasterTileGenerator::kTileSize;
+        for (const QLineF& segment : lines)
+        {
+            if (std::max(segment.y1(), segment.y2()) < firstRow || std::min(segment.y1(), segment.y2()) >= lastRow)
+                continue;
+
+            const double length = std::max(std::abs(segment.dx()), std::abs(segment.dy()));
+            const int steps = std::max(1, static_cast<int>(std::ceil(length)));
+            for (int step = 0; step <= steps; ++step)
+            {
+                const QPointF point = segment.pointAt(static_cast<double>(step) / steps);
+                const int row = static_cast<int>(std::floor(point.y()));
+                const int column = static_cast<int>(std::floor(point.x()));
+                if (row < firstRow || row >= lastRow || column < 0 || column >= size)
+                    continue;
+                auto* pixel = reinterpret_cast<QRgb*>(bits + row * bytesPerLine) + column;
+                *pixel = blend(*pixel, kLineColor);
+            }
+        }
+    }
+} // namespace
+
+H3RasterTileGenerator::H3RasterTileGenerator(H3DataManager* dataManager, QObject* parent) :
+    QObject(parent), m_dataManager(dataManager)
+{
+    m_cache.setMaxCost(kCacheBytes);
+
+    m_revisionTimer.setSingleShot(true);
+    m_revisionTimer.setInterval(kRevisionIntervalMs);
+    connect(&m_revisionTimer, &QTimer::timeout, this,
+            [this]()
+            {
+                ++m_revision;
+                emit revisionChanged();
+            });
+
+    connectDataManager();
+}
+
+void H3RasterTileGenerator::setDataManager(H3DataManager* dataManager)
+{
+    if (m_dataManager == dataManager)
+        return;
+
+    if (m_dataManager)
+        disconnect(m_dataManager, nullptr, this, nullptr);
+    {
+        QWriteLocker locker(&m_dataLock);
+        m_dataManager = dataManager;
+    }
+    connectDataManager();
+    invalidate();
+}
+
+void H3RasterTileGenerator::setColorRamp(const H3ColorRamp& ramp)
+{
+    {
+        QWriteLocker locker(&m_dataLock);
+        m_ramp = ramp;
+    }
+    invalidate();
+}
+
+void H3RasterTileGenerator::connectDataManager()
+{
+    if (!m_dataManager)
+        return;
+
+    connect(m_dataManager, &H3DataManager::dataUpdated, this, &H3RasterTileGenerator::invalidate);
+    connect(m_dataManager, &H3DataManager::dataBatchUpdated, this, &H3RasterTileGenerator::invalidate);
+    connect(m_dataManager, &H3DataManager::dataCleared, this, &H3RasterTileGenerator::invalidate);
+}
+
+void H3RasterTileGenerator::setEnabled(const bool enabled)
+{
+    if (m_enabled.exchange(enabled) == enabled)
+        return;
+
+    // Пока слой был выключен, запросы получали пустые тайлы - MapLibre должен запросить их заново
+    invalidate();
+    emit enabledChanged();
+}
+
+QFuture<QByteArray> H3RasterTileGenerator::requestTile(const int z, const int x, const int y)
+{
+    if (!m_enabled.load() || z > kMaxZoom)
+        return QtFuture::makeReadyFuture(QByteArray());
+
+    const CacheKey key{tileKey(z, x, y), m_version.load()};
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const QByteArray* cached = m_cache.object(key))
+        {
+            H3_COUNTER_ADD(RasterCacheHits, 1);
+            return QtFuture::makeReadyFuture(*cached);
+        }
+    }
+
+    H3_COUNTER_ADD(RasterCacheMisses, 1);
+    const auto render = [this, z, x, y, key]()
+    {
+        QByteArray png;
+        if (const QImage image = renderTile(z, x, y); !image.isNull())
+        {
+            QBuffer buffer(&png);
+            buffer.open(QIODevice::WriteOnly);
+            image.save(&buffer, "PNG");
+        }
+
+        // Отрисовка могла прочитать данные уже после invalidate() - такой тайл не кешируем
+        QMutexLocker locker(&m_cacheMutex);
+        if (key.second == m_version.load())
+        {
+            m_cache.insert(key, new QByteArray(png), std::max<qsizetype>(1, png.size()));
+        }
+        return png;
+    };
+
+    // Тайлы видимой области не ждут фоновой загрузки и обслуживания данных
+    return H3TaskScheduler::instance().run(TaskPriority::Interactive, render);
+}
+
+QByteArray H3RasterTileGenerator::tileJson(const QString& tilesUrl) const
+{
+    QJsonObject tileJson;
+    tileJson.insert("tilejson", "2.2.0");
+    tileJson.insert("name", "h3raster");
+    tileJson.insert("scheme", "xyz");
+    tileJson.insert("tiles", QJsonArray{tilesUrl});
+    tileJson.insert("minzoom", 0);
+    tileJson.insert("maxzoom", kMaxZoom);
+
+    return QJsonDocument(tileJson).toJson(QJsonDocument::Compact);
+}
+
+QImage H3RasterTileGenerator::renderTile(const int z, const int x, const int y) const
+{
+    const int resolution = H3HexagonModel::resolutionForZoom(z);
+    const std::vector<H3Index> cells = H3TileGenerator::cellsInTile(z, x, y, resolution);
+    if (cells.empty())
+        return {};
+
+    // Общие вершины проецируются один раз, общие рёбра рисуются один раз
+    H3TopologyMesh mesh;
+    mesh.build(cells);
+
+    // Значения всех ячеек тайла одним захватом мьютекса данных, цвета - по шкале активного слоя
+    std::vector<double> values(cells.size(), std::numeric_limits<double>::quiet_NaN());
+    std::vector<QRgb> colors(cells.size(), kNoDataColor);
+    {
+        QReadLocker locker(&m_dataLock);
+        if (m_dataManager)
+            m_dataManager->valuesOf(cells, values);
+        for (size_t cell = 0; cell < cells.size(); ++cell)
+        {
+            if (std::isnan(values[cell]))
+                continue;
+            // Прозрачность шкалы сохраняется, сверху - непрозрачность заливки h3-fill
+            const QRgb color = m_ramp.color(values[cell]).rgba();
+            colors[cell] =
+                qPremultiply(qRgba(qRed(color), qGreen(color), qBlue(color), qAlpha(color) * kDataAlpha / 255));
+        }
+    }
+
+    const double worldSize = 1 << z;
+    const double centerX = (x + 0.5) / worldSize;
+    std::vector<double> worldXs;
+    std::vector<double> projectedY;
+    worldXs.reserve(mesh.vertices().size());
+    projectedY.reserve(mesh.vertices().size());
+    for (const H3TopologyMesh::Vertex& vertex : mesh.vertices())
+    {
+        worldXs.push_back(H3PackedGeometry::worldX(vertex.longitude));
+        projectedY.push_back((H3PackedGeometry::worldY(vertex.latitude) * worldSize - y) * kTileSize);
+    }
+    const auto pixelX = [&](const double worldX) { return (worldX * worldSize - x) * kTileSize; };
+
+    // Ячейка через антимеридиан разворачивается вокруг своей первой вершины и сдвигается на целый мир к
+    // центру тайла. На z=0 тайл - весь мир, и вылезающая за край часть рисуется второй копией с другой стороны
+    const auto worldShifts = [&](const double minX, const double maxX, const double middle)
+    {
+        std::array<double, 2> shifts{(unwrap(middle, centerX) - middle), 0.0};
+        int count = 1;
+        if (z == 0 && minX + shifts[0] < 0.0)
+            shifts[count++] = shifts[0] + 1.0;
+        else if (z == 0 && maxX + shifts[0] > 1.0)
+            shifts[count++] = shifts[0] - 1.0;
+        return std::pair{shifts, count};
+    };
+
+    std::vector<Polygon> polygons;
+    polygons.reserve(cells.size());
+    std::array<double, kMaxRingVertices> ringXs;
+    for (size_t cell = 0; cell < cells.size(); ++cell)
+    {
+        const std::span<const uint32_t> ring = mesh.cellRing(cell);
+        if (ring.size() < 3 || ring.size() > kMaxRingVertices)
+            continue;
+
+        double minX = std::numeric_limits<double>::max();
+        double maxX = std::numeric_limits<double>::lowest();
+        for (size_t i = 0; i < ring.size(); ++i)
+        {
+            ringXs[i] = unwrap(worldXs[ring[i]], worldXs[ring.front()]);
+            minX = std::min(minX, ringXs[i]);
+            maxX = std::max(maxX, ringXs[i]);
+        }
+
+        Polygon polygon{};
+        polygon.size = static_cast<int>(ring.size());
+        polygon.top = std::numeric_limits<double>::max();
+        polygon.bottom = std::numeric_limits<double>::lowest();
+        for (int i = 0; i < polygon.size; ++i)
+        {
+            polygon.points[i].setY(projectedY[ring[i]]);
+            polygon.top = std::min(polygon.top, polygon.points[i].y());
+            polygon.bottom = std::max(polygon.bottom, polygon.points[i].y());
+        }
+
+        polygon.color = colors[cell];
+
+        const auto [shifts, count] = worldShifts(minX, maxX, (minX + maxX) / 2.0);
+        for (int copy = 0; copy < count; ++copy)
+        {
+            for (int i = 0; i < polygon.size; ++i)
+                polygon.points[i].setX(pixelX(ringXs[i] + shifts[copy]));
+            polygons.push_back(polygon);
+        }
+    }
+
+    std::vector<QLineF> lines;
+    lines.reserve(mesh.edges().size());
+    for (const H3TopologyMesh::Edge& edge : mesh.edges())
+    {
+        const double first = worldXs[edge.first];
+        const double second = unwrap(worldXs[edge.second], first);
+        const auto [shifts, count] =
+            worldShifts(std::min(first, second), std::max(first, second), (first + second) / 2.0);
+        for (int copy = 0; copy < count; ++copy)
+        {
+            lines.emplace_back(pixelX(first + shifts[copy]), projectedY[edge.first], pixelX(second + shifts[copy]),
+                               projectedY[edge.second]);
+        }
+    }
+
+    QImage image(kTileSize, kTileSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    uchar* bits = image.bits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+
+    // Полосы строк не пересекаются, поэтому пишутся без блокировок. Отрисовка сама идёт в потоке
+    // планировщика - полосы раздаются его же потокам, а не второму пулу
+    H3TaskScheduler& scheduler = H3TaskScheduler::instance();
+    const int bandCount = std::clamp(scheduler.threadCount(), 1, kTileSize);
+    const int bandHeight = (kTileSize + bandCount - 1) / bandCount;
+    scheduler.parallelFor(TaskPriority::Interactive, bandCount,
+                          [&](const int band)
+                          {
+                              const int firstRow = band * bandHeight;
+                              const int lastRow = std::min(kTileSize, firstRow + bandHeight);
+                              fillBand(bits, bytesPerLine, polygons, firstRow, lastRow);
+                              strokeBand(bits, bytesPerLine, lines, firstRow, lastRow);
+                          });
+
+    return image;
+}
+
+void H3RasterTileGenerator::invalidate()
+{
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        m_version.fetch_add(1);
+        m_cache.clear();
+    }
+
+    if (!m_revisionTimer.isActive())
+        m_revisionTimer.start();
+}
+
+quint64 H3RasterTileGenerator::tileKey(const int z, const int x, const int y)
+{
+    return (static_cast<quint64>(z) << 58) | (static_cast<quint64>(x) << 29) | static_cast<quint64>(y);
+}
@@ -0,0 +1,89 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3RASTERGENERATOR_H
+#define H3RASTERGENERATOR_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QTimer>
+
+#include <atomic>
+#include <utility>
+
+#include "h3ColorRamp.h"
+#include "tileProvider.h"
+
+class H3DataManager;
+
+// Растровые тайлы сетки H3 для обзорных зумов, рисуются на CPU: для программного бэкенда Qt Quick, где
+// полигоны QML особенно дороги. Ячейки заливаются построчно с цветами данных, полосы строк тайла
+// обрабатываются параллельно в пуле потоков. MapLibre получает PNG через TileServer как raster source,
+// ревизия в адресе тайлов заставляет его перезапросить их после изменения данных
+class H3RasterTileGenerator : public QObject, public TileProvider {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int revision READ revision NOTIFY revisionChanged)
+    Q_PROPERTY(int maxZoom READ maxZoom CONSTANT)
+    Q_PROPERTY(int tileSize READ tileSize CONSTANT)
+
+public:
+    static constexpr int kMaxZoom = 10;
+    static constexpr int kTileSize = 256;
+
+    explicit H3RasterTileGenerator(H3DataManager *dataManager, QObject *parent = nullptr);
+
+    // Хранилище значений активного слоя; генератору не принадлежит, nullptr - сетка без данных
+    void setDataManager(H3DataManager *dataManager);
+    // Копия шкалы активного слоя: тайлы раскрашиваются так же, как его полигоны
+    void setColorRamp(const H3ColorRamp &ramp);
+
+    bool enabled() const { return m_enabled.load(); }
+    void setEnabled(bool enabled);
+
+    int revision() const { return m_revision; }
+    int maxZoom() const { return kMaxZoom; }
+    int tileSize() const { return kTileSize; }
+
+    QFuture<QByteArray> requestTile(int z, int x, int y) override;
+    QByteArray tileJson(const QString &tilesUrl) const override;
+
+    QByteArray contentType() const override { return "image/png"; }
+    QString extension() const override { return QStringLiteral("png"); }
+
+    // Синхронная отрисовка, безопасна для вызова из любого потока. Пустой тайл - null QImage
+    QImage renderTile(int z, int x, int y) const;
+
+public slots:
+    void invalidate();
+
+signals:
+    void enabledChanged();
+    void revisionChanged();
+
+private:
+    // Тайл и версия данных, с которой он отрисован
+    using CacheKey = std::pair<quint64, quint64>;
+
+    static quint64 tileKey(int z, int x, int y);
+
+    void connectDataManager();
+
+    H3DataManager *m_dataManager;
+    H3ColorRamp m_ramp;
+    mutable QReadWriteLock m_dataLock; // Отрисовка читает хранилище и шкалу, их смена ждёт отрисовок
+    std::atomic<bool> m_enabled{false};
+    std::atomic<quint64> m_version{0};
+
+    QTimer m_revisionTimer; // Ревизию для MapLibre поднимаем не чаще таймера
+    int m_revision{0};
+
+    mutable QMutex m_cacheMutex;
+    QCache<CacheKey, QByteArray> m_cache; // Стоимость - размер PNG в байтах
+};
+
+#endif //H3RASTERGENERATOR_H
@@ -0,0 +1,308 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "h3tilegenerator.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "h3CoarseGeometry.h"
+#include "h3TaskScheduler.h"
+#include "h3datamanager.h"
+#include "h3model.h"
+#include "instrumentation.h"
+#include "mvtEncoder.h"
+#include "tileMath.h"
+
+namespace
+{
+    constexpr quint32 kExtent = 4096;
+    constexpr double kBuffer = 1.0 / 16.0; // Запас вокруг тайла, чтобы ячейки на стыках не обрывались
+    constexpr double kMaxStripWidth = 60.0; // Широкие полигоны H3 трактует как пересекающие антимеридиан
+    constexpr int64_t kMaxCellsPerTile = 50000;
+    constexpr int kCacheBytes = 64 * 1024 * 1024;
+    constexpr int kRevisionIntervalMs = 500;
+} // namespace
+
+H3TileGenerator::H3TileGenerator(H3DataManager* dataManager, QObject* parent) :
+    QObject(parent), m_dataManager(dataManager)
+{
+    m_cache.setMaxCost(kCacheBytes);
+
+    m_revisionTimer.setSingleShot(true);
+    m_revisionTimer.setInterval(kRevisionIntervalMs);
+    connect(&m_revisionTimer, &QTimer::timeout, this,
+            [this]()
+            {
+                ++m_revision;
+                emit revisionChanged();
+            });
+
+    connectDataManager();
+    m_pyramidStale = m_dataManager && !m_dataManager->isEmpty();
+}
+
+void H3TileGenerator::setEnabled(const bool enabled)
+{
+    if (m_enabled.exchange(enabled) == enabled)
+        return;
+
+    invalidate();
+    emit enabledChanged();
+}
+
+void H3TileGenerator::setDataManager(H3DataManager* dataManager)
+{
+    if (m_dataManager == dataManager)
+        return;
+
+    if (m_dataManager)
+        disconnect(m_dataManager, nullptr, this, nullptr);
+    {
+        QWriteLocker locker(&m_dataLock);
+        m_dataManager = dataManager;
+    }
+    connectDataManager();
+    onDataChanged();
+}
+
+void H3TileGenerator::connectDataManager()
+{
+    if (!m_dataManager)
+        return;
+
+    connect(m_dataManager, &H3DataManager::dataUpdated, this, &H3TileGenerator::onDataChanged);
+    connect(m_dataManager, &H3DataManager::dataBatchUpdated, this, &H3TileGenerator::onDataChanged);
+    connect(m_dataManager, &H3DataManager::dataCleared, this, &H3TileGenerator::onDataChanged);
+}
+
+void H3TileGenerator::setPyramid(TileProvider* pyramid, const int minZoom, const int maxZoom)
+{
+    m_pyramid = pyramid;
+    m_pyramidMinZoom = minZoom;
+    m_pyramidMaxZoom = maxZoom;
+}
+
+QFuture<QByteArray> H3TileGenerator::requestTile(const int z, const int x, const int y)
+{
+    // Выключенный слой скрыт в стиле и тайлы не запрашивает
+    if (!m_enabled.load())
+        return QtFuture::makeReadyFuture(QByteArray());
+
+    // Пирамида отдаёт свой диапазон зумов, пока хранилище пусто. Тайлов вне её bbox в ней нет -
+    // их, как и все прочие зумы, генерируем
+    if (m_pyramid && !m_pyramidStale.load() && z >= m_pyramidMinZoom && z <= m_pyramidMaxZoom)
+    {
+        return m_pyramid->requestTile(z, x, y)
+            .then([this, z, x, y](const QByteArray& tile)
+                  { return tile.isEmpty() ? generateAsync(z, x, y) : QtFuture::makeReadyFuture(tile); })
+            .unwrap();
+    }
+
+    return generateAsync(z, x, y);
+}
+
+QFuture<QByteArray> H3TileGenerator::generateAsync(const int z, const int x, const int y)
+{
+    const quint64 key = tileKey(z, x, y);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const QByteArray* cached = m_cache.object(key))
+        {
+            H3_COUNTER_ADD(TileCacheHits, 1);
+            return QtFuture::makeReadyFuture(*cached);
+        }
+    }
+
+    H3_COUNTER_ADD(TileCacheMisses, 1);
+    const quint64 version = m_version.load();
+    const auto generate = [this, z, x, y, key, version]()
+    {
+        QByteArray tile = generateTile(z, x, y);
+
+        QMutexLocker locker(&m_cacheMutex);
+        if (version == m_version.load())
+        {
+            m_cache.insert(key, new QByteArray(tile), std::max<qsizetype>(1, tile.size()));
+        }
+        return tile;
+    };
+
+    // Тайлы видимой области не ждут фоновой загрузки и обслуживания данных
+    return H3TaskScheduler::instance().run(TaskPriority::Interactive, generate);
+}
+
+QByteArray H3TileGenerator::tileJson(const QString& tilesUrl) const
+{
+    QJsonObject tileJson;
+    tileJson.insert("tilejson", "2.2.0");
+    tileJson.insert("name", "h3");
+    tileJson.insert("scheme", "xyz");
+    tileJson.insert("tiles", QJsonArray{tilesUrl});
+    tileJson.insert("minzoom", 0);
+    tileJson.insert("maxzoom", kMaxZoom);
+    tileJson.insert("vector_layers",
+                    QJsonArray{QJsonObject{{"id", "h3"},
+                                           {"fields", QJsonObject{{"h3", "String"}, {"value", "Number"}}}}});
+
+    return QJsonDocument(tileJson).toJson(QJsonDocument::Compact);
+}
+
+QByteArray H3TileGenerator::generateTile(const int z, const int x, const int y) const
+{
+    const int resolution = H3HexagonModel::resolutionForZoom(z);
+    const std::vector<H3Index> cells = cellsInTile(z, x, y, resolution);
+
+    MvtLayer layer("h3", kExtent);
+    const quint32 indexKey = layer.key("h3");
+    const quint32 valueKey = layer.key("value");
+
+    const double centerLng = TileMath::tileXToLng(x + 0.5, z);
+    const double worldSize = 1 << z;
+
+    // Значения всех ячеек тайла одним захватом мьютекса данных
+    std::vector<double> values(cells.size(), std::numeric_limits<double>::quiet_NaN());
+    {
+        QReadLocker locker(&m_dataLock);
+        if (m_dataManager)
+            m_dataManager->valuesOf(cells, values);
+    }
+
+    std::vector<H3CoarseGeometry::Point> points;
+    std::vector<QPoint> ring;
+    std::vector<quint32> tags;
+
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        const H3Index cell = cells[i];
+        points.clear();
+        if (const H3CoarseGeometry::Cell* coarse = H3CoarseGeometry::find(cell))
+        {
+            const std::span<const H3CoarseGeometry::Point> boundary = H3CoarseGeometry::boundary(*coarse);
+            points.assign(boundary.begin(), boundary.end());
+        }
+        else
+        {
+            CellBoundary boundary;
+            if (cellToBoundary(cell, &boundary) != E_SUCCESS)
+                continue;
+            for (int i = 0; i < boundary.numVerts; ++i)
+                points.push_back({radsToDegs(boundary.verts[i].lat), radsToDegs(boundary.verts[i].lng)});
+        }
+
+        ring.clear();
+        for (const H3CoarseGeometry::Point& point : points)
+        {
+            // Разворачиваем долготу относительно центра тайла, чтобы ячейки на антимеридиане не растягивались
+            double lng = point.lng;
+            while (lng - centerLng > 180.0)
+                lng -= 360.0;
+            while (lng - centerLng < -180.0)
+                lng += 360.0;
+
+            const double tileX = (lng + 180.0) / 360.0 * worldSize - x;
+            const double tileY = TileMath::latToTileY(point.lat, z) - y;
+            ring.emplace_back(qRound(tileX * kExtent), qRound(tileY * kExtent));
+        }
+
+        char indexString[17];
+        h3ToString(cell, indexString, sizeof(indexString));
+
+        tags = {indexKey, layer.stringValue(QByteArray(indexString))};
+        if (!std::isnan(values[i]))
+        {
+            tags.push_back(valueKey);
+            tags.push_back(layer.doubleValue(values[i]));
+        }
+
+        layer.addPolygon(cell, ring, tags);
+    }
+
+    return encodeMvtTile({layer});
+}
+
+std::vector<H3Index> H3TileGenerator::cellsInTile(const int z, const int x, const int y, const int resolution)
+{
+    std::vector<H3Index> result;
+
+    const double west = std::max(-180.0, TileMath::tileXToLng(x - kBuffer, z));
+    const double east = std::min(180.0, TileMath::tileXToLng(x + 1 + kBuffer, z));
+    const double north = TileMath::tileYToLat(std::max(0.0, y - kBuffer), z);
+    const double south = TileMath::tileYToLat(std::min<double>(1 << z, y + 1 + kBuffer), z);
+
+    // Крупная сетка уже лежит в таблицах, отсортированная по индексу
+    if (resolution <= H3CoarseGeometry::kMaxResolution)
+        return H3CoarseGeometry::cellsInBounds(resolution, west, south, east, north);
+
+    // На мелких зумах тайл шире полушария - режем на полосы
+    const int strips = std::max(1, static_cast<int>(std::ceil((east - west) / kMaxStripWidth)));
+    const double stripWidth = (east - west) / strips;
+
+    for (int strip = 0; strip < strips; ++strip)
+    {
+        const double left = west + stripWidth * strip;
+        const double right = left + stripWidth;
+
+        LatLng verts[4] = {{degsToRads(north), degsToRads(left)},
+                           {degsToRads(north), degsToRads(right)},
+                           {degsToRads(south), degsToRads(right)},
+                           {degsToRads(south), degsToRads(left)}};
+
+        GeoPolygon polygon;
+        polygon.geoloop.verts = verts;
+        polygon.geoloop.numVerts = 4;
+        polygon.numHoles = 0;
+        polygon.holes = nullptr;
+
+        int64_t size = 0;
+        if (maxPolygonToCellsSizeExperimental(&polygon, resolution, CONTAINMENT_OVERLAPPING_BBOX, &size) !=
+                E_SUCCESS ||
+            size <= 0 || size > kMaxCellsPerTile)
+        {
+            continue;
+        }
+
+        const size_t offset = result.size();
+        result.resize(offset + size, 0);
+        if (polygonToCellsExperimental(&polygon, resolution, CONTAINMENT_OVERLAPPING_BBOX, size,
+                                       result.data() + offset) != E_SUCCESS)
+        {
+            result.resize(offset);
+        }
+    }
+
+    std::erase(result, 0);
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void H3TileGenerator::onDataChanged()
+{
+    // Значения хранилища в пирамиду не попали: она годится, пока оно пусто
+    m_pyramidStale = m_dataManager && !m_dataManager->isEmpty();
+    invalidate();
+}
+
+void H3TileGenerator::invalidate()
+{
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        m_version.fetch_add(1);
+        m_cache.clear();
+    }
+
+    if (!m_revisionTimer.isActive())
+        m_revisionTimer.start();
+}
+
+quint64 H3TileGenerator::tileKey(const int z, const int x, const int y)
+{
+    return (static_cast<quint64>(z) << 58) | (static_cast<quint64>(x) << 29) | static_cast<quint64>(y);
+}
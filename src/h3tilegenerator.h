@@ -0,0 +1,88 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef H3TILEGENERATOR_H
+#define H3TILEGENERATOR_H
+
+#include <QCache>
+#include <QMutex>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QTimer>
+
+#include <atomic>
+#include <h3api.h>
+#include <vector>
+
+#include "tileProvider.h"
+
+class H3DataManager;
+
+// Генерация векторных тайлов (MVT) с сеткой H3 на лету; значения хранилища данных - атрибуты признаков.
+// MapLibre сам не узнает об изменении данных: ревизия входит в адрес тайлов, и с её сменой
+// QML пересоздаёт источник в стиле карты. Заранее собранная h3-tiler пирамида отдаёт тайлы
+// своего диапазона зумов, пока в хранилище нет данных; остальные тайлы генерируются
+class H3TileGenerator : public QObject, public TileProvider {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int revision READ revision NOTIFY revisionChanged)
+    Q_PROPERTY(int maxZoom READ maxZoom CONSTANT)
+
+public:
+    static constexpr int kMaxZoom = 24;
+
+    explicit H3TileGenerator(H3DataManager *dataManager, QObject *parent = nullptr);
+
+    bool enabled() const { return m_enabled.load(); }
+    void setEnabled(bool enabled);
+
+    // Хранилище значений (обычно - активного слоя), генератору не принадлежит. Ждёт начатые генерации,
+    // после возврата прежнее хранилище можно удалять
+    void setDataManager(H3DataManager *dataManager);
+
+    // Пирамида с тайлами зумов minZoom..maxZoom, генератору не принадлежит
+    void setPyramid(TileProvider *pyramid, int minZoom, int maxZoom);
+
+    int revision() const { return m_revision; }
+    int maxZoom() const { return kMaxZoom; }
+
+    QFuture<QByteArray> requestTile(int z, int x, int y) override;
+    QByteArray tileJson(const QString &tilesUrl) const override;
+
+    // Синхронная генерация, безопасна для вызова из любого потока
+    QByteArray generateTile(int z, int x, int y) const;
+    static std::vector<H3Index> cellsInTile(int z, int x, int y, int resolution);
+
+public slots:
+    void invalidate();
+
+signals:
+    void enabledChanged();
+    void revisionChanged();
+
+private:
+    QFuture<QByteArray> generateAsync(int z, int x, int y);
+    void connectDataManager();
+    void onDataChanged();
+
+    static quint64 tileKey(int z, int x, int y);
+
+    H3DataManager *m_dataManager;
+    mutable QReadWriteLock m_dataLock; // Генерация читает хранилище, смена хранилища ждёт генераций
+    TileProvider *m_pyramid{nullptr};
+    int m_pyramidMinZoom{0};
+    int m_pyramidMaxZoom{-1};
+    std::atomic<bool> m_pyramidStale{false}; // В хранилище есть данные, которых нет в пирамиде
+    std::atomic<bool> m_enabled{true};
+    std::atomic<quint64> m_version{0}; // Меняется при изменении данных
+
+    // Поток значений меняет данные много раз в секунду - ревизию для MapLibre поднимаем не чаще таймера
+    QTimer m_revisionTimer;
+    int m_revision{0};
+
+    mutable QMutex m_cacheMutex;
+    QCache<quint64, QByteArray> m_cache; // Стоимость - размер тайла в байтах
+};
+
+#endif //H3TILEGENERATOR_H
@@ -0,0 +1,195 @@
+//
+// Created by user on 10/18/26.
+//
+
+// Офлайн сборка пирамиды векторных тайлов H3 в .mbtiles для h3-viewer
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QtConcurrent/QtConcurrent>
+
+#include <cmath>
+
+#include "h3datamanager.h"
+#include "h3tilegenerator.h"
+#include "mbtilesWriter.h"
+#include "tileMath.h"
+
+namespace
+{
+    constexpr int kBatchSize = 1024;
+
+    struct TileJob {
+        int z;
+        int x;
+        int y;
+        QByteArray data;
+    };
+
+    // CSV: h3index,value (индекс в hex)
+    int loadData(const QString& path, H3DataManager& dataManager)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+            return -1;
+
+        int count = 0;
+        QTextStream stream(&file);
+        while (!stream.atEnd())
+        {
+            const QStringList fields = stream.readLine().split(',');
+            if (fields.size() < 2)
+                continue;
+
+            const H3Index index = H3DataManager::stringToH3Index(fields[0].trimmed());
+            bool ok = false;
+            const double value = fields[1].trimmed().toDouble(&ok);
+            if (!ok || !isValidCell(index))
+                continue;
+
+            H3Data data;
+            data.index = index;
+            data.value = value;
+            dataManager.setHexagonData(index, data);
+            ++count;
+        }
+        return count;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("h3-tiler");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Pre-renders H3 grid vector tiles into an .mbtiles file for h3-viewer");
+    parser.addHelpOption();
+
+    const QCommandLineOption bboxOption("bbox", "Bounding box west,south,east,north in degrees.", "bbox",
+                                        "-180,-85,180,85");
+    const QCommandLineOption minZoomOption("minzoom", "Minimum zoom level.", "zoom", "4");
+    const QCommandLineOption maxZoomOption("maxzoom", "Maximum zoom level.", "zoom", "8");
+    const QCommandLineOption outputOption(
+        {"o", "output"}, "Output .mbtiles file.", "path",
+        QDir::homePath() + QDir::separator() + "h3-viewer" + QDir::separator() + "h3grid.mbtiles");
+    const QCommandLineOption dataOption("data", "CSV file with h3index,value rows for the data layer.", "path");
+    parser.addOptions({bboxOption, minZoomOption, maxZoomOption, outputOption, dataOption});
+    parser.process(app);
+
+    const QStringList bbox = parser.value(bboxOption).split(',');
+    const int minZoom = std::clamp(parser.value(minZoomOption).toInt(), 0, H3TileGenerator::kMaxZoom);
+    const int maxZoom = std::clamp(parser.value(maxZoomOption).toInt(), minZoom, H3TileGenerator::kMaxZoom);
+
+    if (bbox.size() != 4)
+    {
+        qCritical() << "Invalid --bbox, expected west,south,east,north";
+        return 1;
+    }
+
+    const double west = bbox[0].toDouble();
+    const double south = bbox[1].toDouble();
+    const double east = bbox[2].toDouble();
+    const double north = bbox[3].toDouble();
+
+    H3DataManager dataManager;
+    if (parser.isSet(dataOption))
+    {
+        const int loaded = loadData(parser.value(dataOption), dataManager);
+        if (loaded < 0)
+        {
+            qCritical() << "Failed to read data file" << parser.value(dataOption);
+            return 1;
+        }
+        qInfo() << "Loaded" << loaded << "data cells";
+    }
+
+    H3TileGenerator generator(&dataManager);
+
+    const QString output = parser.value(outputOption);
+    QDir().mkpath(QFileInfo(output).absolutePath());
+
+    MbtilesWriter writer(output);
+    if (!writer.open())
+    {
+        qCritical() << "Failed to create" << output << writer.errorString();
+        return 1;
+    }
+
+    const QJsonObject json{
+        {"vector_layers",
+         QJsonArray{QJsonObject{{"id", "h3"},
+                                {"minzoom", minZoom},
+                                {"maxzoom", maxZoom},
+                                {"fields", QJsonObject{{"h3", "String"}, {"value", "Number"}}}}}}};
+
+    writer.setMetadata("name", "h3");
+    writer.setMetadata("format", "pbf");
+    writer.setMetadata("type", "overlay");
+    writer.setMetadata("minzoom", QString::number(minZoom));
+    writer.setMetadata("maxzoom", QString::number(maxZoom));
+    writer.setMetadata("bounds", QStringLiteral("%1,%2,%3,%4").arg(west).arg(south).arg(east).arg(north));
+    writer.setMetadata("center",
+                       QStringLiteral("%1,%2,%3").arg((west + east) / 2).arg((south + north) / 2).arg(minZoom));
+    writer.setMetadata("json", QString::fromUtf8(QJsonDocument(json).toJson(QJsonDocument::Compact)));
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 written = 0;
+
+    for (int z = minZoom; z <= maxZoom; ++z)
+    {
+        const int maxTile = (1 << z) - 1;
+        const int minX = std::clamp(static_cast<int>(std::floor(TileMath::lngToTileX(west, z))), 0, maxTile);
+        const int maxX = std::clamp(static_cast<int>(std::ceil(TileMath::lngToTileX(east, z))) - 1, 0, maxTile);
+        const int minY = std::clamp(static_cast<int>(std::floor(TileMath::latToTileY(north, z))), 0, maxTile);
+        const int maxY = std::clamp(static_cast<int>(std::ceil(TileMath::latToTileY(south, z))) - 1, 0, maxTile);
+
+        QList<TileJob> batch;
+        batch.reserve(kBatchSize);
+
+        // Генерация на всех ядрах, запись в SQLite - из одного потока
+        const auto flush = [&]()
+        {
+            QtConcurrent::blockingMap(batch, [&generator](TileJob& job)
+                                      { job.data = generator.generateTile(job.z, job.x, job.y); });
+            for (const TileJob& job : std::as_const(batch))
+            {
+                if (!job.data.isEmpty() && writer.writeTile(job.z, job.x, job.y, job.data))
+                    ++written;
+            }
+            batch.clear();
+        };
+
+        for (int x = minX; x <= maxX; ++x)
+        {
+            for (int y = minY; y <= maxY; ++y)
+            {
+                batch.append({z, x, y, {}});
+                if (batch.size() == kBatchSize)
+                    flush();
+            }
+        }
+        flush();
+
+        qInfo() << "Zoom" << z << "done," << written << "tiles written," << timer.elapsed() << "ms";
+    }
+
+    if (!writer.commit())
+    {
+        qCritical() << "Failed to commit" << output << writer.errorString();
+        return 1;
+    }
+
+    qInfo() << "Wrote" << written << "tiles to" << output;
+    return 0;
+}
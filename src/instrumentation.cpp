@@ -0,0 +1,165 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "instrumentation.h"
+
+#include <string>
+
+#ifdef H3VIEWER_INSTRUMENTATION
+#include <spdlog/async.h>
+#include <spdlog/cfg/env.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#endif
+
+Instrumentation::Instrumentation()
+{
+#ifdef H3VIEWER_INSTRUMENTATION
+    // Неблокирующая очередь: при переполнении сообщения теряются, а горячий путь не ждёт
+    spdlog::init_thread_pool(8192, 1);
+    m_logger = spdlog::stdout_color_mt<spdlog::async_factory_nonblock>("h3");
+    m_logger->set_pattern("%Y-%m-%d %H:%M:%S.%e %n %l %v");
+    m_logger->set_level(spdlog::level::info);
+    spdlog::cfg::load_env_levels(); // SPDLOG_LEVEL=h3=debug
+#endif
+}
+
+Instrumentation& Instrumentation::instance()
+{
+    static Instrumentation instrumentation;
+    return instrumentation;
+}
+
+const char* Instrumentation::stageName(const Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::Schedule:
+        return "schedule";
+    case Stage::Polyfill:
+        return "polyfill";
+    case Stage::Boundary:
+        return "boundary";
+    case Stage::ModelReset:
+        return "modelReset";
+    case Stage::Present:
+        return "present";
+    case Stage::Render:
+        return "render";
+    case Stage::Frame:
+        return "frame";
+    default:
+        return "unknown";
+    }
+}
+
+const char* Instrumentation::counterName(const Counter counter)
+{
+    switch (counter)
+    {
+    case Counter::Updates:
+        return "updates";
+    case Counter::CellsGenerated:
+        return "cellsGenerated";
+    case Counter::ViewportsRejected:
+        return "viewportsRejected";
+    case Counter::TileCacheHits:
+        return "tileCacheHits";
+    case Counter::TileCacheMisses:
+        return "tileCacheMisses";
+    case Counter::OutlineCacheHits:
+        return "outlineCacheHits";
+    case Counter::OutlineCacheMisses:
+        return "outlineCacheMisses";
+    case Counter::FeedMessages:
+        return "feedMessages";
+    case Counter::FeedDropped:
+        return "feedDropped";
+    case Counter::DelegatesReused:
+        return "delegatesReused";
+    case Counter::DelegatesCreated:
+        return "delegatesCreated";
+    case Counter::RasterCacheHits:
+        return "rasterCacheHits";
+    case Counter::RasterCacheMisses:
+        return "rasterCacheMisses";
+    case Counter::ExtrusionCacheHits:
+        return "extrusionCacheHits";
+    case Counter::ExtrusionCacheMisses:
+        return "extrusionCacheMisses";
+    default:
+        return "unknown";
+    }
+}
+
+int Instrumentation::histogramBucket(const uint64_t ns)
+{
+    int bucket = 0;
+    for (uint64_t bound = kHistogramBaseNs; ns >= bound && bucket < kHistogramBuckets - 1; bound <<= 1)
+        ++bucket;
+    return bucket;
+}
+
+void Instrumentation::recordStage(const Stage stage, const uint64_t ns)
+{
+    AtomicStage& stats = m_stages[static_cast<size_t>(stage)];
+    stats.count.fetch_add(1, std::memory_order_relaxed);
+    stats.totalNs.fetch_add(ns, std::memory_order_relaxed);
+    stats.lastNs.store(ns, std::memory_order_relaxed);
+    stats.histogram[histogramBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = stats.maxNs.load(std::memory_order_relaxed);
+    while (ns > max && !stats.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+void Instrumentation::addCounter(const Counter counter, const uint64_t value)
+{
+    m_counters[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+Instrumentation::StageStats Instrumentation::stage(const Stage stage) const
+{
+    const AtomicStage& stats = m_stages[static_cast<size_t>(stage)];
+    StageStats result{stats.count.load(std::memory_order_relaxed), stats.totalNs.load(std::memory_order_relaxed),
+                      stats.lastNs.load(std::memory_order_relaxed), stats.maxNs.load(std::memory_order_relaxed)};
+    for (int i = 0; i < kHistogramBuckets; ++i)
+        result.histogram[i] = stats.histogram[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+uint64_t Instrumentation::counter(const Counter counter) const
+{
+    return m_counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+void Instrumentation::logSummary()
+{
+#ifdef H3VIEWER_INSTRUMENTATION
+    // Без новых обновлений сводку не повторяем
+    const uint64_t updates = counter(Counter::Updates);
+    if (!m_logger || updates == m_lastSummaryUpdates)
+        return;
+    m_lastSummaryUpdates = updates;
+
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i)
+    {
+        const StageStats stats = stage(static_cast<Stage>(i));
+        if (stats.count == 0)
+            continue;
+        m_logger->info("stage {}: n={} last={:.2f}ms avg={:.2f}ms max={:.2f}ms", stageName(static_cast<Stage>(i)),
+                       stats.count, stats.lastNs / 1e6, stats.totalNs / 1e6 / stats.count, stats.maxNs / 1e6);
+    }
+    std::string counters;
+    for (size_t i = 0; i < static_cast<size_t>(Counter::Count); ++i)
+    {
+        if (!counters.empty())
+            counters += ' ';
+        counters += counterName(static_cast<Counter>(i));
+        counters += '=';
+        counters += std::to_string(counter(static_cast<Counter>(i)));
+    }
+    m_logger->info("counters: {}", counters);
+#endif
+}
@@ -0,0 +1,140 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#ifdef H3VIEWER_INSTRUMENTATION
+#include <spdlog/spdlog.h>
+#endif
+
+namespace spdlog
+{
+    class logger;
+}
+
+// Этапы конвейера: от жеста на карте до кадра с новыми гексагонами
+enum class Stage { Schedule, Polyfill, Boundary, ModelReset, Present, Render, Frame, Count };
+
+// Счётчики событий конвейера
+enum class Counter {
+    Updates,
+    CellsGenerated,
+    ViewportsRejected,
+    TileCacheHits,
+    TileCacheMisses,
+    OutlineCacheHits,
+    OutlineCacheMisses,
+    FeedMessages,
+    FeedDropped,
+    DelegatesReused,
+    DelegatesCreated,
+    RasterCacheHits,
+    RasterCacheMisses,
+    ExtrusionCacheHits,
+    ExtrusionCacheMisses,
+    Count
+};
+
+// Накопители времени этапов и счётчиков; без H3VIEWER_INSTRUMENTATION макросы ниже ничего не делают
+class Instrumentation {
+public:
+    // Гистограмма по степеням двойки: корзина i - замеры короче kHistogramBaseNs * 2^i, последняя - всё остальное
+    static constexpr int kHistogramBuckets = 12;
+    static constexpr uint64_t kHistogramBaseNs = 250'000;
+
+    struct StageStats {
+        uint64_t count{0};
+        uint64_t totalNs{0};
+        uint64_t lastNs{0};
+        uint64_t maxNs{0};
+        std::array<uint64_t, kHistogramBuckets> histogram{};
+    };
+
+    static Instrumentation &instance();
+    static const char *stageName(Stage stage);
+    static const char *counterName(Counter counter);
+    static int histogramBucket(uint64_t ns);
+
+    void recordStage(Stage stage, uint64_t ns);
+    void addCounter(Counter counter, uint64_t value = 1);
+
+    StageStats stage(Stage stage) const;
+    uint64_t counter(Counter counter) const;
+
+    // Асинхронный логгер: запись в вызывающем потоке - только постановка в очередь
+    spdlog::logger *logger() const { return m_logger.get(); }
+    void logSummary();
+
+private:
+    Instrumentation();
+
+    struct AtomicStage {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalNs{0};
+        std::atomic<uint64_t> lastNs{0};
+        std::atomic<uint64_t> maxNs{0};
+        std::array<std::atomic<uint64_t>, kHistogramBuckets> histogram{};
+    };
+
+    std::array<AtomicStage, static_cast<size_t>(Stage::Count)> m_stages;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> m_counters{};
+    uint64_t m_lastSummaryUpdates{0};
+    std::shared_ptr<spdlog::logger> m_logger;
+};
+
+// Замер этапа на время жизни объекта
+class StageTimer {
+public:
+    explicit StageTimer(const Stage stage) : m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+    ~StageTimer()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        Instrumentation::instance().recordStage(
+            m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+private:
+    Stage m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#ifdef H3VIEWER_INSTRUMENTATION
+
+#define H3_INSTR_CONCAT_IMPL(a, b) a##b
+#define H3_INSTR_CONCAT(a, b) H3_INSTR_CONCAT_IMPL(a, b)
+
+#define H3_STAGE_TIMER(stage) const StageTimer H3_INSTR_CONCAT(stageTimer_, __LINE__)(Stage::stage)
+#define H3_COUNTER_ADD(counter, value) Instrumentation::instance().addCounter(Counter::counter, value)
+
+// Аргументы вычисляются только если уровень включён
+#define H3_LOG(severity, ...)                                                                                          \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        spdlog::logger *h3Logger = Instrumentation::instance().logger();                                               \
+        if (h3Logger && h3Logger->should_log(spdlog::level::severity))                                                 \
+            h3Logger->log(spdlog::level::severity, __VA_ARGS__);                                                       \
+    } while (0)
+
+#else
+
+#define H3_STAGE_TIMER(stage) static_cast<void>(0)
+#define H3_COUNTER_ADD(counter, value) static_cast<void>(0)
+#define H3_LOG(severity, ...) static_cast<void>(0)
+
+#endif
+
+#define H3_LOG_DEBUG(...) H3_LOG(debug, __VA_ARGS__)
+#define H3_LOG_WARN(...) H3_LOG(warn, __VA_ARGS__)
+
+#endif //INSTRUMENTATION_H
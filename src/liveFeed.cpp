@@ -0,0 +1,263 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "liveFeed.h"
+
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QtEndian>
+
+#include <bit>
+
+#include "instrumentation.h"
+
+namespace
+{
+    constexpr int kReconnectIntervalMs = 2000;
+    constexpr int kStatisticsIntervalMs = 1000;
+    constexpr size_t kCoalesceReserve = 1 << 16;
+
+    // Живёт в потоке чтения: держит сокет, режет поток байт на записи и отдаёт их в очередь
+    class LiveFeedReader : public QObject {
+    public:
+        LiveFeedReader(LiveFeed* feed, const QString& source) : m_feed(feed), m_source(source)
+        {
+            m_reconnectTimer.setSingleShot(true);
+            m_reconnectTimer.setInterval(kReconnectIntervalMs);
+            connect(&m_reconnectTimer, &QTimer::timeout, this, &LiveFeedReader::open);
+        }
+
+        void open()
+        {
+            if (!m_socket)
+                createSocket();
+
+            m_pending.clear();
+            if (auto* tcp = qobject_cast<QTcpSocket*>(m_socket))
+            {
+                const QUrl url(m_source);
+                tcp->abort();
+                tcp->connectToHost(url.host(), url.port());
+            }
+            else if (auto* local = qobject_cast<QLocalSocket*>(m_socket))
+            {
+                local->abort();
+                local->connectToServer(m_source);
+            }
+        }
+
+    private:
+        void createSocket()
+        {
+            if (m_source.startsWith(QLatin1String("tcp://")))
+            {
+                auto* socket = new QTcpSocket(this);
+                socket->setReadBufferSize(0);
+                connect(socket, &QTcpSocket::connected, this, [this]() { m_feed->setConnected(true); });
+                connect(socket, &QTcpSocket::disconnected, this, &LiveFeedReader::onDisconnected);
+                connect(socket, &QTcpSocket::errorOccurred, this, &LiveFeedReader::onDisconnected);
+                m_socket = socket;
+            }
+            else
+            {
+                auto* socket = new QLocalSocket(this);
+                connect(socket, &QLocalSocket::connected, this, [this]() { m_feed->setConnected(true); });
+                connect(socket, &QLocalSocket::disconnected, this, &LiveFeedReader::onDisconnected);
+                connect(socket, &QLocalSocket::errorOccurred, this, &LiveFeedReader::onDisconnected);
+                m_socket = socket;
+            }
+            connect(m_socket, &QIODevice::readyRead, this, &LiveFeedReader::onReadyRead);
+        }
+
+        void onReadyRead()
+        {
+            m_pending.append(m_socket->readAll());
+
+            // Хвост неполной записи ждёт следующей порции
+            const qsizetype records = m_pending.size() / LiveFeed::kRecordSize;
+            if (records == 0)
+                return;
+
+            m_feed->enqueue(m_pending.constData(), records);
+            m_pending.remove(0, records * LiveFeed::kRecordSize);
+        }
+
+        void onDisconnected()
+        {
+            m_feed->setConnected(false);
+            if (!m_reconnectTimer.isActive())
+                m_reconnectTimer.start();
+        }
+
+        LiveFeed* m_feed;
+        QString m_source;
+        QIODevice* m_socket{nullptr};
+        QByteArray m_pending;
+        QTimer m_reconnectTimer;
+    };
+} // namespace
+
+LiveFeed::LiveFeed(QObject* parent) : QObject(parent) { m_coalesced.reserve(kCoalesceReserve); }
+
+LiveFeed::~LiveFeed()
+{
+    stop();
+
+    // Задача приёма держит this
+    m_ingestToken.cancel();
+    H3TaskScheduler::instance().waitForDone();
+}
+
+void LiveFeed::start(const QString& source)
+{
+    stop();
+
+    m_source = source;
+    emit sourceChanged();
+
+    auto* reader = new LiveFeedReader(this, source);
+    reader->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, reader, &QObject::deleteLater);
+
+    m_thread.setObjectName("LiveFeed");
+    m_thread.start();
+    QMetaObject::invokeMethod(reader, [reader]() { reader->open(); }, Qt::QueuedConnection);
+
+    m_rateTimer.start();
+    m_rateReceived = m_received.load(std::memory_order_relaxed);
+}
+
+void LiveFeed::stop()
+{
+    if (!m_thread.isRunning())
+        return;
+
+    m_thread.quit();
+    m_thread.wait();
+    setConnected(false);
+}
+
+void LiveFeed::attachWindow(QQuickWindow* window)
+{
+    if (m_window)
+        disconnect(m_window, nullptr, this, nullptr);
+
+    m_window = window;
+    // afterAnimating приходит в GUI потоке перед синхронизацией кадра
+    if (m_window)
+        connect(m_window, &QQuickWindow::afterAnimating, this, &LiveFeed::drain);
+}
+
+void LiveFeed::enqueue(const char* records, const qsizetype count)
+{
+    qint64 dropped = 0;
+    for (qsizetype i = 0; i < count; ++i)
+    {
+        const char* record = records + i * kRecordSize;
+        const Update update{qFromLittleEndian<quint64>(record),
+                            std::bit_cast<double>(qFromLittleEndian<quint64>(record + sizeof(quint64)))};
+        if (!m_queue.tryPush(update))
+            ++dropped;
+    }
+
+    m_received.fetch_add(count, std::memory_order_relaxed);
+    if (dropped)
+        m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+    H3_COUNTER_ADD(FeedMessages, count);
+    H3_COUNTER_ADD(FeedDropped, dropped);
+
+    // Флаг после записи в очередь: приём, сбросивший его раньше, эти записи ещё увидит
+    m_unread.store(true);
+    requestDrain();
+}
+
+void LiveFeed::setConnected(const bool connected)
+{
+    if (m_connected.exchange(connected, std::memory_order_relaxed) != connected)
+        QMetaObject::invokeMethod(this, &LiveFeed::connectedChanged, Qt::QueuedConnection);
+}
+
+void LiveFeed::requestDrain()
+{
+    // Одна заявка на кадр, сколько бы пакетов ни пришло
+    if (m_drainPending.exchange(true, std::memory_order_acq_rel))
+        return;
+
+    QMetaObject::invokeMethod(
+        this,
+        [this]()
+        {
+            if (m_window)
+                m_window->update();
+            else
+                drain();
+        },
+        Qt::QueuedConnection);
+}
+
+void LiveFeed::drain()
+{
+    m_drainPending.store(false, std::memory_order_release);
+
+    // Разбор очереди - фоновый приём в планировщике, в кадре остаётся только запись готового пакета.
+    // Пока приём идёт, второй не ставим: о записях, пришедших за это время, задача узнает по m_unread
+    if (!m_ingesting.exchange(true))
+    {
+        H3TaskScheduler::instance().submit(
+            TaskPriority::Ingest, [this](const CancellationToken&) { ingest(); }, m_ingestToken);
+    }
+
+    if (m_rateTimer.isValid() && m_rateTimer.elapsed() >= kStatisticsIntervalMs)
+    {
+        const qint64 received = m_received.load(std::memory_order_relaxed);
+        m_messagesPerSecond = (received - m_rateReceived) * 1000.0 / m_rateTimer.restart();
+        m_rateReceived = received;
+        emit statisticsChanged();
+    }
+}
+
+void LiveFeed::ingest()
+{
+    m_unread.store(false);
+
+    // Забираем не больше ёмкости очереди, чтобы поток-писатель не держал задачу бесконечно.
+    // Битый или сдвинутый поток даёт мусорные индексы - в хранилище и индекс они не попадают
+    qint64 invalid = 0;
+    const size_t taken = m_queue.drain(
+        [this, &invalid](const Update& update)
+        {
+            if (isValidCell(update.index))
+                m_coalesced[update.index] = update.value;
+            else
+                ++invalid;
+        },
+        m_queue.capacity());
+
+    if (invalid)
+    {
+        m_dropped.fetch_add(invalid, std::memory_order_relaxed);
+        H3_COUNTER_ADD(FeedDropped, invalid);
+    }
+
+    std::vector<std::pair<H3Index, double>> batch(m_coalesced.begin(), m_coalesced.end());
+    m_coalesced.clear();
+
+    m_ingesting.store(false);
+    if (taken == m_queue.capacity() || m_unread.load())
+        requestDrain();
+
+    if (!batch.empty())
+    {
+        QMetaObject::invokeMethod(
+            this,
+            [this, batch = std::move(batch)]()
+            {
+                if (m_layer)
+                    m_layer->dataManager()->setValues(batch);
+            },
+            Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef LIVEFEED_H
+#define LIVEFEED_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QThread>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include <h3api.h>
+
+#include "h3FlatMap.h"
+#include "h3TaskScheduler.h"
+#include "h3layer.h"
+#include "mpscQueue.h"
+
+// Поток обновлений (H3Index, value) из локального сокета. Поток-читатель только разбирает записи
+// и кладёт их в lock-free очередь. Раз в кадр GUI поток ставит задачу приёма в планировщик: она забирает
+// очередь и схлопывает повторы по ячейке, а GUI поток пишет готовый пакет в слой.
+// Формат: записи по 16 байт little-endian - uint64 индекс ячейки, double значение.
+// Источник: "tcp://host:port" или имя локального сокета (QLocalSocket)
+class LiveFeed : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QString source READ source NOTIFY sourceChanged)
+    Q_PROPERTY(bool connected READ isConnected NOTIFY connectedChanged)
+    Q_PROPERTY(double messagesPerSecond READ messagesPerSecond NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 dropped READ dropped NOTIFY statisticsChanged)
+
+public:
+    static constexpr qsizetype kRecordSize = 16;
+    static constexpr size_t kQueueCapacity = 1 << 18;
+
+    struct Update {
+        H3Index index;
+        double value;
+    };
+
+    explicit LiveFeed(QObject *parent = nullptr);
+    ~LiveFeed() override;
+
+    void start(const QString &source);
+    void stop();
+
+    // Куда писать значения
+    void setLayer(H3Layer *layer) { m_layer = layer; }
+    // Очередь забирается на afterAnimating окна, без окна - сразу по приходу данных
+    void attachWindow(QQuickWindow *window);
+
+    QString source() const { return m_source; }
+    bool isConnected() const { return m_connected.load(std::memory_order_relaxed); }
+    double messagesPerSecond() const { return m_messagesPerSecond; }
+    // Не попавшие в очередь из-за переполнения и записи с невалидным индексом ячейки
+    qint64 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Вызывается потоком-читателем
+    void enqueue(const char *records, qsizetype count);
+    void setConnected(bool connected);
+
+signals:
+    void sourceChanged();
+    void connectedChanged();
+    void statisticsChanged();
+
+private:
+    void requestDrain();
+    void drain();
+    // Задача приёма в потоке планировщика; одновременно идёт не больше одной
+    void ingest();
+
+    QString m_source;
+    QThread m_thread;
+    QPointer<H3Layer> m_layer;
+    QPointer<QQuickWindow> m_window;
+
+    MpscQueue<Update> m_queue{kQueueCapacity};
+    std::atomic<bool> m_drainPending{false};
+    std::atomic<bool> m_ingesting{false};
+    std::atomic<bool> m_unread{false}; // Записи, пришедшие после начала приёма
+    CancellationToken m_ingestToken;
+    std::atomic<bool> m_connected{false};
+    std::atomic<qint64> m_received{0};
+    std::atomic<qint64> m_dropped{0};
+
+    // Буфер задачи приёма переиспользуется между кадрами
+    H3FlatMap<double> m_coalesced;
+
+    QElapsedTimer m_rateTimer;
+    qint64 m_rateReceived{0};
+    double m_messagesPerSecond{0.0};
+};
+
+#endif //LIVEFEED_H
@@ -14,7 +14,16 @@ int main(int argc, char *argv[]) {
     qputenv("QSG_RENDER_LOOP", "basic"); // basic //threaded
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGLRhi);
+    // H3VIEWER_GRAPHICS_API: software - растеризатор Qt Quick без GPU (headless бенчмарк с QT_QPA_PLATFORM=offscreen),
+    // llvmpipe - OpenGL через программный Mesa, иначе - аппаратный OpenGL
+    const QByteArray graphicsApi = qgetenv("H3VIEWER_GRAPHICS_API");
+    if (graphicsApi == "software") {
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    } else {
+        if (graphicsApi == "llvmpipe")
+            qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGLRhi);
+    }
 #endif
 
     Application::setHighDpiScaleFactorRoundingPolicy(Qt::HighDpiScaleFactorRoundingPolicy::RoundPreferFloor);
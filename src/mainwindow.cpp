@@ -5,6 +5,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QQmlComponent>
 #include <QQmlContext>
 #include <QRandomGenerator>
@@ -18,10 +19,20 @@ MainWindow::MainWindow(QObject *parent)
     std::srand(QDateTime::currentMSecsSinceEpoch() / 1000);
 
     qmlRegisterType<H3HexagonModel>("H3VIEWER", 1, 0, "H3HexagonModel");
+    qmlRegisterType<ViewportController>("H3VIEWER", 1, 0, "ViewportController");
+    qmlRegisterType<H3LayerManager>("H3VIEWER", 1, 0, "H3LayerManager");
+    qmlRegisterType<H3DelegatePool>("H3VIEWER", 1, 0, "H3DelegatePool");
+    qmlRegisterUncreatableType<H3Layer>("H3VIEWER", 1, 0, "H3Layer", "Layers are created by H3LayerManager");
 
     h3HexagonModel_ = new H3HexagonModel();
     engine_.rootContext()->setContextProperty("H3HexagonModel", h3HexagonModel_);
 
+    performanceMetrics_ = new PerformanceMetrics(this);
+    engine_.rootContext()->setContextProperty("perfMetrics", performanceMetrics_);
+
+    liveFeed_ = new LiveFeed(this);
+    engine_.rootContext()->setContextProperty("liveFeed", liveFeed_);
+
     initMapProvider();
     initEngine();
 
@@ -29,6 +40,8 @@ MainWindow::MainWindow(QObject *parent)
 }
 
 MainWindow::~MainWindow() {
+    // Задачи генераторов тайлов в общем пуле не должны пережить сами генераторы
+    H3TaskScheduler::instance().waitForDone();
     mapProvider_->deleteLater();
     h3HexagonModel_->deleteLater();
     rootWindow_->deleteLater();
@@ -45,6 +58,10 @@ void MainWindow::initEngine() {
                     rootWindow_ = qobject_cast<QQuickWindow *>(obj);
                     if (!rootWindow_)
                         qWarning() << "Корневой объект не является QQuickWindow!";
+                    performanceMetrics_->attachWindow(rootWindow_);
+                    initBenchmark();
+                    initDataLayer();
+                    initLiveFeed();
                 }
             },
             Qt::QueuedConnection);
@@ -54,6 +71,113 @@ void MainWindow::initEngine() {
 void MainWindow::initMapProvider() {
     mapProvider_ = new MapProvider();
     engine_.rootContext()->setContextProperty("mapProvider", mapProvider_);
-    const QString pathToMap = "mbtiles://" + QDir::homePath() + QDir::separator() + QApplication::applicationName() + QDir::separator() + "map.mbtiles";
+    const QString mbtilesPath = QDir::homePath() + QDir::separator() + QApplication::applicationName() + QDir::separator() + "map.mbtiles";
+    initTileServer(mbtilesPath);
+
+    // Если локальный сервер поднялся, тайлы идут через него, иначе - напрямую через плагин
+    QString pathToMap = "mbtiles://" + mbtilesPath;
+    if (mbtilesSource_->isOpen() && tileServer_->isListening())
+        pathToMap = tileServer_->tileJsonUrl("basemap");
     mapProvider_->exchangeUrl(pathToMap);
-}
\ No newline at end of file
+}
+
+void MainWindow::initTileServer(const QString &mbtilesPath) {
+    tileServer_ = new TileServer(this);
+    mbtilesSource_ = new MbtilesSource(mbtilesPath, this);
+    // Значения оверлеям даёт активный слой данных, его назначает initDataLayer
+    h3TileGenerator_ = new H3TileGenerator(nullptr, this);
+    h3RasterGenerator_ = new H3RasterTileGenerator(nullptr, this);
+    h3ExtrusionGenerator_ = new H3ExtrusionTileGenerator(nullptr, this);
+
+    // Сетка H3 рисуется самим MapLibre: в диапазоне заранее собранной h3-tiler пирамиды тайлы берутся
+    // из неё, остальные генерируются на лету
+    auto *h3Grid = new MbtilesSource(QFileInfo(mbtilesPath).dir().filePath("h3grid.mbtiles"), this);
+    if (h3Grid->open())
+        h3TileGenerator_->setPyramid(h3Grid, h3Grid->minZoom(), h3Grid->maxZoom());
+    else
+        delete h3Grid;
+
+    // Без GPU полигоны QML дороже всего - обзорные зумы рисуем растром на CPU
+    if (QQuickWindow::graphicsApi() == QSGRendererInterface::Software)
+        h3RasterGenerator_->setEnabled(true);
+
+    if (tileServer_->listen()) {
+        if (mbtilesSource_->open())
+            tileServer_->addProvider("basemap", mbtilesSource_);
+        tileServer_->addProvider("h3", h3TileGenerator_);
+        tileServer_->addProvider("h3raster", h3RasterGenerator_);
+        tileServer_->addProvider("h3extrusion", h3ExtrusionGenerator_);
+    } else {
+        h3TileGenerator_->setEnabled(false);
+    }
+
+    performanceMetrics_->addCache(
+            "basemap", [this]() { return static_cast<quint64>(mbtilesSource_->cacheHits()); },
+            [this]() { return static_cast<quint64>(mbtilesSource_->cacheMisses()); });
+    performanceMetrics_->addScheduler(&H3TaskScheduler::instance());
+
+    engine_.rootContext()->setContextProperty("tileServer", tileServer_);
+    engine_.rootContext()->setContextProperty("tileSource", mbtilesSource_);
+    engine_.rootContext()->setContextProperty("h3Tiles", h3TileGenerator_);
+    engine_.rootContext()->setContextProperty("h3Raster", h3RasterGenerator_);
+    engine_.rootContext()->setContextProperty("h3Extrusion", h3ExtrusionGenerator_);
+}
+
+void MainWindow::initBenchmark() {
+    // H3VIEWER_BENCHMARK=<report.json> - пройти траекторию (H3VIEWER_BENCHMARK_TRAJECTORY или встроенную) и выйти
+    const QString reportPath = qEnvironmentVariable("H3VIEWER_BENCHMARK");
+    if (reportPath.isEmpty() || !rootWindow_)
+        return;
+
+    benchmarkDriver_ = new BenchmarkDriver(rootWindow_, reportPath, this);
+
+    const QString trajectoryPath = qEnvironmentVariable("H3VIEWER_BENCHMARK_TRAJECTORY");
+    if (!trajectoryPath.isEmpty() && !benchmarkDriver_->loadTrajectory(trajectoryPath))
+        qWarning() << "Не удалось загрузить траекторию" << trajectoryPath << "- используется встроенная";
+
+    benchmarkDriver_->start();
+}
+
+void MainWindow::initLiveFeed() {
+    // H3VIEWER_LIVE_FEED=tcp://host:port или имя локального сокета - значения пишутся в слой "live"
+    const QString source = qEnvironmentVariable("H3VIEWER_LIVE_FEED");
+    if (source.isEmpty() || !rootWindow_)
+        return;
+
+    auto *layerManager = rootWindow_->findChild<H3LayerManager *>();
+    if (!layerManager) {
+        qWarning() << "H3LayerManager не найден, live feed не запущен";
+        return;
+    }
+
+    liveFeed_->setLayer(layerManager->addLayer("live"));
+    liveFeed_->attachWindow(rootWindow_);
+    liveFeed_->start(source);
+}
+
+void MainWindow::initDataLayer() {
+    auto *layerManager = rootWindow_ ? rootWindow_->findChild<H3LayerManager *>() : nullptr;
+    if (!layerManager)
+        return;
+
+    connect(layerManager, &H3LayerManager::activeLayerChanged, this,
+            [this, layerManager]() { bindDataLayer(layerManager->activeLayer()); });
+    bindDataLayer(layerManager->activeLayer());
+}
+
+void MainWindow::bindDataLayer(H3Layer *layer) {
+    if (dataLayer_)
+        disconnect(dataLayer_, &H3Layer::rampChanged, this, nullptr);
+    dataLayer_ = layer;
+
+    H3DataManager *dataManager = layer ? layer->dataManager() : nullptr;
+    h3TileGenerator_->setDataManager(dataManager);
+    h3RasterGenerator_->setDataManager(dataManager);
+    h3ExtrusionGenerator_->setDataManager(dataManager);
+
+    // Растр раскрашивается на CPU - шкалу слоя копируем при каждой её смене
+    h3RasterGenerator_->setColorRamp(layer ? layer->ramp() : H3ColorRamp());
+    if (layer)
+        connect(layer, &H3Layer::rampChanged, this,
+                [this, layer]() { h3RasterGenerator_->setColorRamp(layer->ramp()); });
+}
@@ -1,14 +1,27 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QPointer>
 #include <QQmlApplicationEngine>
 #include <QQuickWindow>
 
 
+#include "benchmarkDriver.h"
+#include "delegatePool.h"
+#include "liveFeed.h"
 #include "mapProvider.h"
+#include "mbtilesSource.h"
+#include "performanceMetrics.h"
+#include "tileServer.h"
 
+#include "h3TaskScheduler.h"
 #include "h3datamanager.h"
+#include "h3layermanager.h"
 #include "h3model.h"
+#include "h3extrusiongenerator.h"
+#include "h3rastergenerator.h"
+#include "h3tilegenerator.h"
+#include "viewportController.h"
 
 class MainWindow final : public QObject {
     Q_OBJECT
@@ -19,12 +32,26 @@ public:
 private:
     void initEngine();
     void initMapProvider();
+    void initTileServer(const QString &mbtilesPath);
+    void initBenchmark();
+    void initLiveFeed();
+    void initDataLayer();
+    void bindDataLayer(H3Layer *layer);
 
     QQmlApplicationEngine engine_;
     QQuickWindow *rootWindow_;
     MapProvider *mapProvider_{};
+    TileServer *tileServer_{};
+    MbtilesSource *mbtilesSource_{};
+    H3TileGenerator *h3TileGenerator_{};
+    H3RasterTileGenerator *h3RasterGenerator_{};
+    H3ExtrusionTileGenerator *h3ExtrusionGenerator_{};
+    PerformanceMetrics *performanceMetrics_{};
+    BenchmarkDriver *benchmarkDriver_{};
+    LiveFeed *liveFeed_{};
 
     H3HexagonModel *h3HexagonModel_{};
+    QPointer<H3Layer> dataLayer_;
 };
 
 
@@ -0,0 +1,309 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "mbtilesSource.h"
+#include "tileMath.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <zlib.h>
+
+namespace
+{
+    constexpr qint64 kMmapSize = 256LL * 1024 * 1024;
+    constexpr int kCacheBytes = 64 * 1024 * 1024;
+    constexpr int kMaxPrefetchTiles = 32;
+} // namespace
+
+MbtilesSource::MbtilesSource(const QString& path, QObject* parent) : QObject(parent), m_path(path)
+{
+    m_cache.setMaxCost(kCacheBytes);
+}
+
+MbtilesSource::~MbtilesSource()
+{
+    // Задачи держат this: невзятые выбрасываем, начатые дожидаемся
+    m_prefetchToken.cancel();
+    H3TaskScheduler::instance().waitForDone();
+
+    QMutexLocker locker(&m_connectionsMutex);
+    for (const QString& name : std::as_const(m_connectionNames))
+    {
+        QSqlDatabase::removeDatabase(name);
+    }
+}
+
+bool MbtilesSource::open()
+{
+    if (!QFile::exists(m_path))
+        return false;
+
+    QSqlDatabase db = connection();
+    if (!db.isOpen())
+        return false;
+
+    QSqlQuery query(db);
+    if (!query.exec(QStringLiteral("SELECT name, value FROM metadata")))
+    {
+        qWarning() << "Failed to read mbtiles metadata:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next())
+    {
+        m_metadata.insert(query.value(0).toString(), query.value(1).toString());
+    }
+
+    m_minZoom = m_metadata.value("minzoom").toString("0").toInt();
+    m_maxZoom = m_metadata.value("maxzoom").toString("14").toInt();
+    m_open = true;
+    return true;
+}
+
+QFuture<QByteArray> MbtilesSource::requestTile(const int z, const int x, const int y)
+{
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const QByteArray* cached = m_cache.object(tileKey(z, x, y)))
+        {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return QtFuture::makeReadyFuture(*cached);
+        }
+    }
+
+    // Запросы карты важнее предзагрузки
+    return H3TaskScheduler::instance().run(TaskPriority::Interactive, [this, z, x, y]() { return fetchTile(z, x, y); });
+}
+
+QByteArray MbtilesSource::tileJson(const QString& tilesUrl) const
+{
+    QJsonObject tileJson;
+    tileJson.insert("tilejson", "2.2.0");
+    tileJson.insert("name", m_metadata.value("name"));
+    tileJson.insert("scheme", "xyz");
+    tileJson.insert("tiles", QJsonArray{tilesUrl});
+    tileJson.insert("minzoom", m_minZoom);
+    tileJson.insert("maxzoom", m_maxZoom);
+
+    const QStringList bounds = m_metadata.value("bounds").toString().split(',');
+    if (bounds.size() == 4)
+    {
+        QJsonArray array;
+        for (const QString& value : bounds)
+        {
+            array.append(value.toDouble());
+        }
+        tileJson.insert("bounds", array);
+    }
+
+    // В поле json лежит описание vector_layers
+    const QJsonObject json = QJsonDocument::fromJson(m_metadata.value("json").toString().toUtf8()).object();
+    if (json.contains("vector_layers"))
+    {
+        tileJson.insert("vector_layers", json.value("vector_layers"));
+    }
+
+    return QJsonDocument(tileJson).toJson(QJsonDocument::Compact);
+}
+
+void MbtilesSource::updateViewport(const QGeoRectangle& viewport, const double zoom)
+{
+    if (!m_open || !viewport.isValid())
+        return;
+
+    const int z = std::clamp(static_cast<int>(std::floor(zoom)), m_minZoom, m_maxZoom);
+    const int maxTile = (1 << z) - 1;
+
+    const double left = TileMath::lngToTileX(viewport.topLeft().longitude(), z);
+    const double right = TileMath::lngToTileX(viewport.bottomRight().longitude(), z);
+    const double top = TileMath::latToTileY(viewport.topLeft().latitude(), z);
+    const double bottom = TileMath::latToTileY(viewport.bottomRight().latitude(), z);
+
+    const double centerX = (left + right) / 2.0;
+    const double centerY = (top + bottom) / 2.0;
+
+    // Направление движения в тайлах; при смене зума движения нет
+    int dirX = 0;
+    int dirY = 0;
+    if (z == m_lastZoom)
+    {
+        const double dx = centerX - m_lastCenterX;
+        const double dy = centerY - m_lastCenterY;
+        dirX = std::abs(dx) > 0.05 ? (dx > 0 ? 1 : -1) : 0;
+        dirY = std::abs(dy) > 0.05 ? (dy > 0 ? 1 : -1) : 0;
+    }
+    m_lastCenterX = centerX;
+    m_lastCenterY = centerY;
+    m_lastZoom = z;
+
+    // Кольцо прошлого viewport больше не нужно: невзятые задачи выбрасываются, нужные тайлы ставятся заново
+    m_prefetchToken.cancel();
+    m_prefetchToken = CancellationToken();
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        m_pending.clear();
+    }
+
+    const int minX = static_cast<int>(std::floor(left));
+    const int maxX = static_cast<int>(std::floor(right));
+    const int minY = static_cast<int>(std::floor(top));
+    const int maxY = static_cast<int>(std::floor(bottom));
+
+    // Кольцо в один тайл вокруг экрана, по направлению движения - на два тайла дальше
+    const int fromX = std::max(0, minX - 1 - (dirX < 0 ? 2 : 0));
+    const int toX = std::min(maxTile, maxX + 1 + (dirX > 0 ? 2 : 0));
+    const int fromY = std::max(0, minY - 1 - (dirY < 0 ? 2 : 0));
+    const int toY = std::min(maxTile, maxY + 1 + (dirY > 0 ? 2 : 0));
+
+    int scheduled = 0;
+    for (int x = fromX; x <= toX && scheduled < kMaxPrefetchTiles; ++x)
+    {
+        for (int y = fromY; y <= toY && scheduled < kMaxPrefetchTiles; ++y)
+        {
+            // Видимые тайлы MapLibre запросит сам
+            if (x >= minX && x <= maxX && y >= minY && y <= maxY)
+                continue;
+
+            prefetchTile(z, x, y);
+            ++scheduled;
+        }
+    }
+
+    emit statisticsChanged();
+}
+
+QByteArray MbtilesSource::fetchTile(const int z, const int x, const int y)
+{
+    const quint64 key = tileKey(z, x, y);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const QByteArray* cached = m_cache.object(key))
+        {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return *cached;
+        }
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    QByteArray tile = decompress(readTile(z, x, y));
+
+    QMutexLocker locker(&m_cacheMutex);
+    m_pending.remove(key);
+    m_cache.insert(key, new QByteArray(tile), std::max<qsizetype>(1, tile.size()));
+    return tile;
+}
+
+QByteArray MbtilesSource::readTile(const int z, const int x, const int y)
+{
+    QSqlDatabase db = connection();
+    if (!db.isOpen())
+        return {};
+
+    QSqlQuery query(db);
+    query.prepare(
+        QStringLiteral("SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?"));
+    query.addBindValue(z);
+    query.addBindValue(x);
+    query.addBindValue((1 << z) - 1 - y); // В mbtiles строки в схеме TMS
+
+    if (!query.exec() || !query.next())
+        return {};
+
+    return query.value(0).toByteArray();
+}
+
+QSqlDatabase MbtilesSource::connection()
+{
+    // Соединения QtSql привязаны к потоку, поэтому у каждого потока планировщика своё
+    const QString name = QStringLiteral("mbtiles_%1_%2")
+                             .arg(reinterpret_cast<quintptr>(this))
+                             .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+
+    if (QSqlDatabase::contains(name))
+        return QSqlDatabase::database(name);
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), name);
+    db.setDatabaseName(m_path);
+    db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+
+    if (!db.open())
+    {
+        qWarning() << "Failed to open mbtiles:" << db.lastError().text();
+        return db;
+    }
+
+    QSqlQuery(db).exec(QStringLiteral("PRAGMA mmap_size = %1").arg(kMmapSize));
+
+    QMutexLocker locker(&m_connectionsMutex);
+    m_connectionNames.append(name);
+    return db;
+}
+
+void MbtilesSource::prefetchTile(const int z, const int x, const int y)
+{
+    const quint64 key = tileKey(z, x, y);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (m_cache.contains(key) || m_pending.contains(key))
+            return;
+        m_pending.insert(key);
+    }
+
+    H3TaskScheduler::instance().submit(
+        TaskPriority::Prefetch, [this, z, x, y](const CancellationToken&) { fetchTile(z, x, y); }, m_prefetchToken);
+}
+
+QByteArray MbtilesSource::decompress(const QByteArray& data)
+{
+    if (data.size() < 2)
+        return data;
+
+    // Тайлы обычно сжаты gzip, реже zlib; несжатый pbf начинается с тега слоя 0x1a
+    const auto first = static_cast<uchar>(data[0]);
+    const auto second = static_cast<uchar>(data[1]);
+    const bool gzip = first == 0x1f && second == 0x8b;
+    const bool zlib = (first & 0x0f) == 8 && ((first << 8) | second) % 31 == 0;
+    if (!gzip && !zlib)
+        return data;
+
+    z_stream stream{};
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) // +32 - автоопределение заголовка
+        return {};
+
+    QByteArray out(data.size() * 4, Qt::Uninitialized);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    int ret = Z_OK;
+    while (ret == Z_OK)
+    {
+        if (stream.total_out >= static_cast<uLong>(out.size()))
+        {
+            out.resize(out.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(out.data()) + stream.total_out;
+        stream.avail_out = static_cast<uInt>(out.size() - stream.total_out);
+        ret = inflate(&stream, Z_NO_FLUSH);
+    }
+    inflateEnd(&stream);
+
+    if (ret != Z_STREAM_END)
+        return {};
+
+    out.resize(static_cast<qsizetype>(stream.total_out));
+    return out;
+}
+
+quint64 MbtilesSource::tileKey(const int z, const int x, const int y)
+{
+    return (static_cast<quint64>(z) << 58) | (static_cast<quint64>(x) << 29) | static_cast<quint64>(y);
+}
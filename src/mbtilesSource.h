@@ -0,0 +1,82 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef MBTILESSOURCE_H
+#define MBTILESSOURCE_H
+
+#include <QCache>
+#include <QGeoRectangle>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QSqlDatabase>
+
+#include <atomic>
+
+#include "h3TaskScheduler.h"
+#include "tileProvider.h"
+
+// Векторные тайлы из локального .mbtiles: read-only соединения SQLite с mmap в потоках общего планировщика,
+// LRU кеш разжатых тайлов и предзагрузка по направлению движения карты
+class MbtilesSource : public QObject, public TileProvider {
+    Q_OBJECT
+    Q_PROPERTY(int cacheHits READ cacheHits NOTIFY statisticsChanged)
+    Q_PROPERTY(int cacheMisses READ cacheMisses NOTIFY statisticsChanged)
+
+public:
+    explicit MbtilesSource(const QString &path, QObject *parent = nullptr);
+    ~MbtilesSource() override;
+
+    bool open();
+    bool isOpen() const { return m_open; }
+    // Диапазон зумов из metadata, известен после open()
+    int minZoom() const { return m_minZoom; }
+    int maxZoom() const { return m_maxZoom; }
+
+    QFuture<QByteArray> requestTile(int z, int x, int y) override;
+    QByteArray tileJson(const QString &tilesUrl) const override;
+
+    int cacheHits() const { return m_hits.load(std::memory_order_relaxed); }
+    int cacheMisses() const { return m_misses.load(std::memory_order_relaxed); }
+
+public slots:
+    // Вызывается при каждом изменении viewport, по смещению центра определяем направление движения
+    void updateViewport(const QGeoRectangle &viewport, double zoom);
+
+signals:
+    void statisticsChanged();
+
+private:
+    QByteArray fetchTile(int z, int x, int y);
+    QByteArray readTile(int z, int x, int y);
+    QSqlDatabase connection();
+    void prefetchTile(int z, int x, int y);
+
+    static QByteArray decompress(const QByteArray &data);
+    static quint64 tileKey(int z, int x, int y);
+
+    QString m_path;
+    bool m_open{false};
+    QJsonObject m_metadata;
+    int m_minZoom{0};
+    int m_maxZoom{14};
+
+    mutable QMutex m_cacheMutex;
+    QCache<quint64, QByteArray> m_cache; // Стоимость - размер тайла в байтах
+    QSet<quint64> m_pending;             // Тайлы, которые уже читаются
+
+    CancellationToken m_prefetchToken; // Предзагрузка прошлого viewport, которая ещё не началась
+    QMutex m_connectionsMutex;         // Каждый поток планировщика держит своё соединение
+    QStringList m_connectionNames;
+
+    double m_lastCenterX{0.0};
+    double m_lastCenterY{0.0};
+    int m_lastZoom{-1};
+
+    std::atomic<int> m_hits{0};
+    std::atomic<int> m_misses{0};
+};
+
+#endif //MBTILESSOURCE_H
@@ -0,0 +1,122 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "mbtilesWriter.h"
+
+#include <QFile>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include <zlib.h>
+
+MbtilesWriter::MbtilesWriter(const QString& path) :
+    m_path(path), m_connectionName(QStringLiteral("mbtiles_writer_%1").arg(reinterpret_cast<quintptr>(this)))
+{
+}
+
+MbtilesWriter::~MbtilesWriter()
+{
+    if (m_db.isOpen())
+    {
+        m_db.rollback();
+        m_db.close();
+    }
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool MbtilesWriter::open()
+{
+    QFile::remove(m_path);
+
+    m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_connectionName);
+    m_db.setDatabaseName(m_path);
+    if (!m_db.open())
+    {
+        m_error = m_db.lastError().text();
+        return false;
+    }
+
+    // Файл пишется один раз целиком - журнал не нужен
+    return exec(QStringLiteral("PRAGMA journal_mode = OFF")) && exec(QStringLiteral("PRAGMA synchronous = OFF")) &&
+        exec(QStringLiteral("CREATE TABLE metadata (name TEXT, value TEXT)")) &&
+        exec(QStringLiteral("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, "
+                            "tile_data BLOB)")) &&
+        exec(QStringLiteral("CREATE UNIQUE INDEX tile_index ON tiles (zoom_level, tile_column, tile_row)")) &&
+        m_db.transaction();
+}
+
+bool MbtilesWriter::setMetadata(const QString& name, const QString& value)
+{
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral("INSERT INTO metadata (name, value) VALUES (?, ?)"));
+    query.addBindValue(name);
+    query.addBindValue(value);
+    if (!query.exec())
+    {
+        m_error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool MbtilesWriter::writeTile(const int z, const int x, const int y, const QByteArray& data)
+{
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral("INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data) "
+                                 "VALUES (?, ?, ?, ?)"));
+    query.addBindValue(z);
+    query.addBindValue(x);
+    query.addBindValue((1 << z) - 1 - y); // TMS
+    query.addBindValue(gzip(data));
+    if (!query.exec())
+    {
+        m_error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool MbtilesWriter::commit()
+{
+    if (!m_db.commit())
+    {
+        m_error = m_db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QByteArray MbtilesWriter::gzip(const QByteArray& data)
+{
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) // +16 - gzip
+        return {};
+
+    QByteArray out(static_cast<qsizetype>(deflateBound(&stream, static_cast<uLong>(data.size()))), Qt::Uninitialized);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    const int ret = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+
+    if (ret != Z_STREAM_END)
+        return {};
+
+    out.resize(static_cast<qsizetype>(stream.total_out));
+    return out;
+}
+
+bool MbtilesWriter::exec(const QString& statement)
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(statement))
+    {
+        m_error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
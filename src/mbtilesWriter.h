@@ -0,0 +1,36 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef MBTILESWRITER_H
+#define MBTILESWRITER_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+// Запись тайлов в .mbtiles (схема TMS, данные сжимаются gzip)
+class MbtilesWriter {
+public:
+    explicit MbtilesWriter(const QString &path);
+    ~MbtilesWriter();
+
+    // Создаёт схему и открывает транзакцию; существующий файл перезаписывается
+    bool open();
+    bool setMetadata(const QString &name, const QString &value);
+    bool writeTile(int z, int x, int y, const QByteArray &data);
+    bool commit();
+
+    QString errorString() const { return m_error; }
+
+    static QByteArray gzip(const QByteArray &data);
+
+private:
+    bool exec(const QString &statement);
+
+    QString m_path;
+    QString m_connectionName;
+    QSqlDatabase m_db;
+    QString m_error;
+};
+
+#endif //MBTILESWRITER_H
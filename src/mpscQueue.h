@@ -0,0 +1,102 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Ограниченная lock-free очередь много писателей / один читатель (ячейки с номерами последовательности).
+// Писатели резервируют позицию CAS-ом, читатель забирает без атомарных RMW. При переполнении tryPush
+// возвращает false - решение о потере сообщения принимает вызывающий
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity) :
+        m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), m_cells(std::make_unique<Cell[]>(m_mask + 1))
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    size_t capacity() const { return m_mask + 1; }
+
+    bool tryPush(const T &value)
+    {
+        size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = &m_cells[position & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0)
+            {
+                if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false; // Очередь заполнена
+            }
+            else
+            {
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Только из потока-читателя
+    bool tryPop(T &value)
+    {
+        Cell &cell = m_cells[m_dequeuePosition & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(m_dequeuePosition + 1) < 0)
+            return false;
+
+        value = cell.value;
+        cell.sequence.store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePosition;
+        return true;
+    }
+
+    // Забирает не больше limit элементов, возвращает их количество. Только из потока-читателя
+    template <typename Consumer>
+    size_t drain(Consumer &&consumer, size_t limit)
+    {
+        size_t count = 0;
+        T value;
+        while (count < limit && tryPop(value))
+        {
+            consumer(value);
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_enqueuePosition{0};
+    alignas(64) size_t m_dequeuePosition{0};
+};
+
+#endif //MPSCQUEUE_H
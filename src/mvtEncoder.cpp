@@ -0,0 +1,215 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "mvtEncoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    enum WireType { Varint = 0, Fixed64 = 1, LengthDelimited = 2 };
+
+    enum Command { MoveTo = 1, LineTo = 2, ClosePath = 7 };
+
+    void writeVarint(QByteArray& out, quint64 value)
+    {
+        while (value >= 0x80)
+        {
+            out.append(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+
+    void writeTag(QByteArray& out, const int field, const WireType type) { writeVarint(out, (field << 3) | type); }
+
+    void writeBytes(QByteArray& out, const int field, const QByteArray& bytes)
+    {
+        writeTag(out, field, LengthDelimited);
+        writeVarint(out, bytes.size());
+        out.append(bytes);
+    }
+
+    void writePacked(QByteArray& out, const int field, const std::vector<quint32>& values)
+    {
+        QByteArray packed;
+        packed.reserve(static_cast<qsizetype>(values.size()) * 2);
+        for (const quint32 value : values)
+        {
+            writeVarint(packed, value);
+        }
+        writeBytes(out, field, packed);
+    }
+
+    quint32 command(const Command id, const quint32 count) { return (id & 0x7) | (count << 3); }
+
+    quint32 zigzag(const qint32 value) { return (static_cast<quint32>(value) << 1) ^ static_cast<quint32>(value >> 31); }
+
+    // Координаты в геометрии - смещения от предыдущей точки
+    void appendPoints(std::vector<quint32>& geometry, QPoint& cursor, const QPoint* points, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            geometry.push_back(zigzag(points[i].x() - cursor.x()));
+            geometry.push_back(zigzag(points[i].y() - cursor.y()));
+            cursor = points[i];
+        }
+    }
+} // namespace
+
+MvtLayer::MvtLayer(const QByteArray& name, const quint32 extent) : m_name(name), m_extent(extent) {}
+
+quint32 MvtLayer::key(const QByteArray& name)
+{
+    if (const auto it = m_keyIndex.constFind(name); it != m_keyIndex.cend())
+        return it.value();
+
+    const auto index = static_cast<quint32>(m_keys.size());
+    m_keys.append(name);
+    m_keyIndex.insert(name, index);
+    return index;
+}
+
+quint32 MvtLayer::stringValue(const QByteArray& value)
+{
+    QByteArray encoded;
+    writeBytes(encoded, 1, value);
+    return this->value(encoded);
+}
+
+quint32 MvtLayer::doubleValue(const double value)
+{
+    quint64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    QByteArray encoded;
+    writeTag(encoded, 3, Fixed64);
+    for (int i = 0; i < 8; ++i)
+    {
+        encoded.append(static_cast<char>((bits >> (8 * i)) & 0xff)); // little-endian
+    }
+    return this->value(encoded);
+}
+
+quint32 MvtLayer::value(const QByteArray& encoded)
+{
+    if (const auto it = m_valueIndex.constFind(encoded); it != m_valueIndex.cend())
+        return it.value();
+
+    const auto index = static_cast<quint32>(m_values.size());
+    m_values.append(encoded);
+    m_valueIndex.insert(encoded, index);
+    return index;
+}
+
+void MvtLayer::addPolygon(const quint64 id, std::vector<QPoint> ring, const std::vector<quint32>& tags)
+{
+    // После округления до сетки тайла соседние вершины могут совпасть
+    ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    while (ring.size() > 1 && ring.front() == ring.back())
+    {
+        ring.pop_back();
+    }
+    if (ring.size() < 3)
+        return;
+
+    // Внешнее кольцо должно иметь положительную площадь (по часовой при оси Y вниз)
+    qint64 area = 0;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+    {
+        area += static_cast<qint64>(ring[j].x()) * ring[i].y() - static_cast<qint64>(ring[i].x()) * ring[j].y();
+    }
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        std::reverse(ring.begin(), ring.end());
+    }
+
+    std::vector<quint32> geometry;
+    geometry.reserve(ring.size() * 2 + 3);
+
+    QPoint cursor(0, 0);
+    geometry.push_back(command(MoveTo, 1));
+    appendPoints(geometry, cursor, ring.data(), 1);
+    geometry.push_back(command(LineTo, static_cast<quint32>(ring.size() - 1)));
+    appendPoints(geometry, cursor, ring.data() + 1, ring.size() - 1);
+    geometry.push_back(command(ClosePath, 1));
+
+    addFeature(id, 3, geometry, tags);
+}
+
+void MvtLayer::addLineString(const quint64 id, const std::vector<QPoint>& line, const std::vector<quint32>& tags)
+{
+    if (line.size() < 2 || (line.size() == 2 && line.front() == line.back()))
+        return;
+
+    std::vector<quint32> geometry;
+    geometry.reserve(line.size() * 2 + 2);
+
+    QPoint cursor(0, 0);
+    geometry.push_back(command(MoveTo, 1));
+    appendPoints(geometry, cursor, line.data(), 1);
+    geometry.push_back(command(LineTo, static_cast<quint32>(line.size() - 1)));
+    appendPoints(geometry, cursor, line.data() + 1, line.size() - 1);
+
+    addFeature(id, 2, geometry, tags);
+}
+
+void MvtLayer::addFeature(const quint64 id, const int type, const std::vector<quint32>& geometry,
+                          const std::vector<quint32>& tags)
+{
+    QByteArray feature;
+    feature.reserve(static_cast<qsizetype>(geometry.size()) * 2 + 32);
+
+    writeTag(feature, 1, Varint);
+    writeVarint(feature, id);
+    if (!tags.empty())
+    {
+        writePacked(feature, 2, tags);
+    }
+    writeTag(feature, 3, Varint);
+    writeVarint(feature, type);
+    writePacked(feature, 4, geometry);
+
+    writeBytes(m_features, 2, feature);
+    ++m_featureCount;
+}
+
+QByteArray MvtLayer::encode() const
+{
+    QByteArray layer;
+    layer.reserve(m_features.size() + 256);
+
+    writeTag(layer, 15, Varint);
+    writeVarint(layer, 2); // Версия спецификации
+    writeBytes(layer, 1, m_name);
+    layer.append(m_features);
+    for (const QByteArray& key : m_keys)
+    {
+        writeBytes(layer, 3, key);
+    }
+    for (const QByteArray& value : m_values)
+    {
+        writeBytes(layer, 4, value);
+    }
+    writeTag(layer, 5, Varint);
+    writeVarint(layer, m_extent);
+
+    return layer;
+}
+
+QByteArray encodeMvtTile(const std::vector<MvtLayer>& layers)
+{
+    QByteArray tile;
+    for (const MvtLayer& layer : layers)
+    {
+        if (!layer.isEmpty())
+        {
+            writeBytes(tile, 3, layer.encode());
+        }
+    }
+    return tile;
+}
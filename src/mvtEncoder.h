@@ -0,0 +1,52 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef MVTENCODER_H
+#define MVTENCODER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPoint>
+
+#include <vector>
+
+// Слой Mapbox Vector Tile (спецификация 2.1); protobuf кодируется вручную
+class MvtLayer {
+public:
+    explicit MvtLayer(const QByteArray &name, quint32 extent = 4096);
+
+    // Индексы в таблицах ключей/значений слоя, из пар (ключ, значение) собираются теги признака
+    quint32 key(const QByteArray &name);
+    quint32 stringValue(const QByteArray &value);
+    quint32 doubleValue(double value);
+
+    // Кольцо передаётся без повтора первой точки, ориентация приводится к требуемой спецификацией
+    void addPolygon(quint64 id, std::vector<QPoint> ring, const std::vector<quint32> &tags);
+    void addLineString(quint64 id, const std::vector<QPoint> &line, const std::vector<quint32> &tags);
+
+    bool isEmpty() const { return m_featureCount == 0; }
+    int featureCount() const { return m_featureCount; }
+    quint32 extent() const { return m_extent; }
+
+    QByteArray encode() const;
+
+private:
+    void addFeature(quint64 id, int type, const std::vector<quint32> &geometry, const std::vector<quint32> &tags);
+    quint32 value(const QByteArray &encoded);
+
+    QByteArray m_name;
+    quint32 m_extent;
+    QByteArray m_features; // Уже закодированные признаки
+    int m_featureCount{0};
+
+    QList<QByteArray> m_keys;
+    QHash<QByteArray, quint32> m_keyIndex;
+    QList<QByteArray> m_values; // Закодированные сообщения Value
+    QHash<QByteArray, quint32> m_valueIndex;
+};
+
+QByteArray encodeMvtTile(const std::vector<MvtLayer> &layers);
+
+#endif //MVTENCODER_H
@@ -0,0 +1,201 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "performanceMetrics.h"
+
+#include <QQuickWindow>
+
+#include <chrono>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "h3TaskScheduler.h"
+#include "instrumentation.h"
+
+namespace
+{
+    constexpr int kRefreshIntervalMs = 500;
+    constexpr int kSummaryEveryTicks = 20; // Сводка в лог раз в 10 секунд
+
+    QVariantMap cacheEntry(const QString& name, const quint64 hits, const quint64 misses)
+    {
+        const quint64 total = hits + misses;
+        return QVariantMap{{"name", name},
+                           {"hits", static_cast<qulonglong>(hits)},
+                           {"misses", static_cast<qulonglong>(misses)},
+                           {"hitRate", total ? static_cast<double>(hits) / total : 0.0}};
+    }
+} // namespace
+
+PerformanceMetrics::PerformanceMetrics(QObject* parent) : QObject(parent)
+{
+    if (!enabled())
+        return;
+
+    m_timer.setInterval(kRefreshIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &PerformanceMetrics::refresh);
+    m_timer.start();
+}
+
+bool PerformanceMetrics::enabled() const
+{
+#ifdef H3VIEWER_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+QVariantList PerformanceMetrics::histogramBounds() const
+{
+    QVariantList bounds;
+    for (int i = 0; i < Instrumentation::kHistogramBuckets - 1; ++i)
+        bounds.append(static_cast<double>(Instrumentation::kHistogramBaseNs << i) / 1e6);
+    return bounds;
+}
+
+void PerformanceMetrics::addScheduler(const H3TaskScheduler* scheduler)
+{
+    if (scheduler)
+        m_schedulers.append(scheduler);
+}
+
+void PerformanceMetrics::attachWindow(QQuickWindow* window)
+{
+    if (!window || !enabled())
+        return;
+
+    // Сигналы приходят из потока рендера, поэтому только DirectConnection и без обращения к QML
+    connect(window, &QQuickWindow::beforeSynchronizing, this, [this]() { m_frameStartNs = nowNs(); },
+            Qt::DirectConnection);
+    connect(window, &QQuickWindow::beforeRendering, this, [this]() { m_renderStartNs = nowNs(); },
+            Qt::DirectConnection);
+    connect(
+        window, &QQuickWindow::afterRendering, this,
+        [this]()
+        {
+            if (m_renderStartNs)
+                Instrumentation::instance().recordStage(Stage::Render, nowNs() - m_renderStartNs);
+        },
+        Qt::DirectConnection);
+    connect(
+        window, &QQuickWindow::frameSwapped, this,
+        [this]()
+        {
+            const qint64 now = nowNs();
+            if (m_frameStartNs)
+                Instrumentation::instance().recordStage(Stage::Frame, now - m_frameStartNs);
+            if (const qint64 start = m_presentStartNs.exchange(0))
+                Instrumentation::instance().recordStage(Stage::Present, now - start);
+        },
+        Qt::DirectConnection);
+}
+
+void PerformanceMetrics::addCache(const QString& name, std::function<quint64()> hits,
+                                  std::function<quint64()> misses)
+{
+    m_cacheSources.append({name, std::move(hits), std::move(misses)});
+}
+
+void PerformanceMetrics::trackModel(H3HexagonModel* model)
+{
+    if (!model || !enabled())
+        return;
+
+    // Модель создаётся в QML, поэтому подключается оттуда
+    connect(model, &H3HexagonModel::updateFinished, this, [this]() { m_presentStartNs.store(nowNs()); });
+}
+
+void PerformanceMetrics::refresh()
+{
+    const Instrumentation& instrumentation = Instrumentation::instance();
+
+    QVariantList stages;
+    for (int i = 0; i < static_cast<int>(Stage::Count); ++i)
+    {
+        const auto stage = static_cast<Stage>(i);
+        const Instrumentation::StageStats stats = instrumentation.stage(stage);
+
+        QVariantList histogram;
+        for (const uint64_t bucket : stats.histogram)
+            histogram.append(static_cast<qulonglong>(bucket));
+
+        stages.append(QVariantMap{{"name", Instrumentation::stageName(stage)},
+                                  {"count", static_cast<qulonglong>(stats.count)},
+                                  {"lastMs", stats.lastNs / 1e6},
+                                  {"avgMs", stats.count ? stats.totalNs / 1e6 / stats.count : 0.0},
+                                  {"maxMs", stats.maxNs / 1e6},
+                                  {"histogram", histogram}});
+    }
+
+    QVariantMap counters;
+    for (int i = 0; i < static_cast<int>(Counter::Count); ++i)
+    {
+        const auto counter = static_cast<Counter>(i);
+        counters.insert(Instrumentation::counterName(counter),
+                        static_cast<qulonglong>(instrumentation.counter(counter)));
+    }
+
+    QVariantList caches;
+    for (const Cache& cache : std::as_const(m_cacheSources))
+        caches.append(cacheEntry(cache.name, cache.hits(), cache.misses()));
+    caches.append(cacheEntry("h3 tiles", instrumentation.counter(Counter::TileCacheHits),
+                             instrumentation.counter(Counter::TileCacheMisses)));
+    caches.append(cacheEntry("outlines", instrumentation.counter(Counter::OutlineCacheHits),
+                             instrumentation.counter(Counter::OutlineCacheMisses)));
+    caches.append(cacheEntry("raster tiles", instrumentation.counter(Counter::RasterCacheHits),
+                             instrumentation.counter(Counter::RasterCacheMisses)));
+    caches.append(cacheEntry("extrusion tiles", instrumentation.counter(Counter::ExtrusionCacheHits),
+                             instrumentation.counter(Counter::ExtrusionCacheMisses)));
+    caches.append(cacheEntry("delegates", instrumentation.counter(Counter::DelegatesReused),
+                             instrumentation.counter(Counter::DelegatesCreated)));
+
+    QVariantList queues;
+    for (const H3TaskScheduler* scheduler : std::as_const(m_schedulers))
+    {
+        for (int i = 0; i < static_cast<int>(TaskPriority::Count); ++i)
+        {
+            const auto priority = static_cast<TaskPriority>(i);
+            const H3TaskScheduler::ClassStats stats = scheduler->stats(priority);
+            queues.append(QVariantMap{{"name", H3TaskScheduler::priorityName(priority)},
+                                      {"queued", stats.queued},
+                                      {"running", stats.running},
+                                      {"limit", stats.limit},
+                                      {"completed", static_cast<qulonglong>(stats.completed)},
+                                      {"cancelled", static_cast<qulonglong>(stats.cancelled)},
+                                      {"avgWaitMs", stats.started ? stats.totalWaitNs / 1e6 / stats.started : 0.0},
+                                      {"maxWaitMs", stats.maxWaitNs / 1e6}});
+        }
+    }
+
+    m_stages = stages;
+    m_counters = counters;
+    m_caches = caches;
+    m_queues = queues;
+    m_allocatedBytes = heapBytes();
+    emit updated();
+
+    if (++m_ticks % kSummaryEveryTicks == 0)
+        Instrumentation::instance().logSummary();
+}
+
+qint64 PerformanceMetrics::heapBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    // Занятые блоки кучи плюс крупные выделения через mmap
+    const struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+qint64 PerformanceMetrics::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
@@ -0,0 +1,84 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef PERFORMANCEMETRICS_H
+#define PERFORMANCEMETRICS_H
+
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <atomic>
+#include <functional>
+
+#include "h3model.h"
+
+class QQuickWindow;
+class H3TaskScheduler;
+
+// Снимок Instrumentation для QML: обновляется по таймеру, а не на каждый замер
+class PerformanceMetrics : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled CONSTANT)
+    Q_PROPERTY(QVariantList stages READ stages NOTIFY updated)
+    Q_PROPERTY(QVariantMap counters READ counters NOTIFY updated)
+    Q_PROPERTY(QVariantList caches READ caches NOTIFY updated)
+    Q_PROPERTY(QVariantList queues READ queues NOTIFY updated)
+    Q_PROPERTY(QVariantList histogramBounds READ histogramBounds CONSTANT)
+    Q_PROPERTY(qint64 allocatedBytes READ allocatedBytes NOTIFY updated)
+
+public:
+    explicit PerformanceMetrics(QObject *parent = nullptr);
+
+    bool enabled() const;
+    QVariantList stages() const { return m_stages; }
+    QVariantMap counters() const { return m_counters; }
+    QVariantList caches() const { return m_caches; }
+    QVariantList queues() const { return m_queues; }
+    QVariantList histogramBounds() const;
+    qint64 allocatedBytes() const { return m_allocatedBytes; }
+
+    // Кадры сцены: Render - beforeRendering..afterRendering, Frame - beforeSynchronizing..frameSwapped
+    void attachWindow(QQuickWindow *window);
+
+    // Кеш, который сам ведёт статистику попаданий
+    void addCache(const QString &name, std::function<quint64()> hits, std::function<quint64()> misses);
+
+    // Present - от конца обновления модели до первого показанного после него кадра
+    Q_INVOKABLE void trackModel(H3HexagonModel *model);
+
+signals:
+    void updated();
+
+private:
+    struct Cache {
+        QString name;
+        std::function<quint64()> hits;
+        std::function<quint64()> misses;
+    };
+
+    void refresh();
+    static qint64 heapBytes();
+    static qint64 nowNs();
+
+    QTimer m_timer;
+    int m_ticks{0};
+
+    std::atomic<qint64> m_presentStartNs{0}; // 0 - ждать кадра не нужно
+    qint64 m_renderStartNs{0};               // Только из потока рендера
+    qint64 m_frameStartNs{0};                // Только из потока рендера
+
+    QList<Cache> m_cacheSources;
+    QList<const H3TaskScheduler *> m_schedulers;
+
+    QVariantList m_stages;
+    QVariantMap m_counters;
+    QVariantList m_caches;
+    QVariantList m_queues;
+    qint64 m_allocatedBytes{-1};
+};
+
+#endif //PERFORMANCEMETRICS_H
@@ -0,0 +1,89 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "resolutionSelector.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <h3api.h>
+#include <numbers>
+
+namespace
+{
+    constexpr int kMaxResolution = 15;
+    constexpr double kEarthCircumference = 40075016.686;
+    constexpr double kTileSize = 256.0;
+    constexpr double kMaxLatitude = 85.0;
+
+    // Соседние разрешения отличаются по ребру в sqrt(7) раз; держим текущее до 0.7 шага вместо 0.5
+    constexpr double kHysteresis = 0.2;
+    const double kLogStep = std::log(std::sqrt(7.0));
+
+    // Площадь шестиугольника через ребро: 3 * sqrt(3) / 2 * a^2
+    constexpr double kHexagonAreaFactor = 2.598076211353316;
+} // namespace
+
+void ResolutionSelector::setTargetCellSize(const double pixels)
+{
+    m_targetCellSize = std::max(1.0, pixels);
+    reset();
+}
+
+int ResolutionSelector::select(const double zoom, const double latitude, const double devicePixelRatio,
+                               const QSizeF& viewportPixels)
+{
+    const double metersPerDevicePixel = metersPerPixel(zoom, latitude) / std::max(0.1, devicePixelRatio);
+    const double screenPixels = viewportPixels.width() * viewportPixels.height() * devicePixelRatio * devicePixelRatio;
+
+    const auto distance = [&](const int resolution)
+    { return std::abs(std::log(edgePixels(resolution, metersPerDevicePixel) / m_targetCellSize)) / kLogStep; };
+    const auto fits = [&](const int resolution)
+    { return cellsOnScreen(edgePixels(resolution, metersPerDevicePixel), screenPixels) <= m_maxCells; };
+
+    if (m_current >= 0 && distance(m_current) < 0.5 + kHysteresis && fits(m_current))
+        return m_current;
+
+    int best = 0;
+    for (int resolution = 1; resolution <= kMaxResolution; ++resolution)
+    {
+        if (distance(resolution) < distance(best))
+            best = resolution;
+    }
+
+    // Большое окно: укрупняем, пока ячеек не станет меньше предела
+    while (best > 0 && !fits(best))
+        --best;
+
+    m_current = best;
+    return best;
+}
+
+double ResolutionSelector::metersPerPixel(const double zoom, const double latitude)
+{
+    const double lat = std::clamp(latitude, -kMaxLatitude, kMaxLatitude) * std::numbers::pi / 180.0;
+    return kEarthCircumference * std::cos(lat) / (kTileSize * std::pow(2.0, zoom));
+}
+
+double ResolutionSelector::edgeLengthM(const int resolution)
+{
+    static const std::array<double, kMaxResolution + 1> edges = []()
+    {
+        std::array<double, kMaxResolution + 1> result{};
+        for (int i = 0; i <= kMaxResolution; ++i)
+            getHexagonEdgeLengthAvgM(i, &result[i]);
+        return result;
+    }();
+    return edges[std::clamp(resolution, 0, kMaxResolution)];
+}
+
+double ResolutionSelector::edgePixels(const int resolution, const double metersPerDevicePixel) const
+{
+    return edgeLengthM(resolution) / metersPerDevicePixel;
+}
+
+double ResolutionSelector::cellsOnScreen(const double edgePixels, const double screenPixels)
+{
+    return screenPixels / (kHexagonAreaFactor * edgePixels * edgePixels);
+}
@@ -0,0 +1,40 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef RESOLUTIONSELECTOR_H
+#define RESOLUTIONSELECTOR_H
+
+#include <QSizeF>
+
+// Выбор разрешения H3 по экранному размеру ячейки: средняя длина ребра (getHexagonEdgeLengthAvgM)
+// переводится в физические пиксели на текущей широте и зуме, берётся ближайшее к целевому размеру.
+// Гистерезис держит текущее разрешение, пока оно не ушло заметно дальше середины между соседними
+class ResolutionSelector {
+public:
+    static constexpr double kDefaultTargetCellSize = 96.0; // Ребро в физических пикселях, близко к ZOOM_TO_H3_RES
+    static constexpr int kDefaultMaxCells = 4000;          // На экран; запрос с упреждением больше в 2-2.5 раза
+
+    double targetCellSize() const { return m_targetCellSize; }
+    void setTargetCellSize(double pixels);
+
+    int maxCells() const { return m_maxCells; }
+    void setMaxCells(int cells) { m_maxCells = cells; }
+
+    int select(double zoom, double latitude, double devicePixelRatio, const QSizeF &viewportPixels);
+    void reset() { m_current = -1; }
+
+    // Метры на логический пиксель Web-Mercator (тайл 256 px, как у зума QtLocation)
+    static double metersPerPixel(double zoom, double latitude);
+    static double edgeLengthM(int resolution);
+
+private:
+    double edgePixels(int resolution, double metersPerDevicePixel) const;
+    static double cellsOnScreen(double edgePixels, double screenPixels);
+
+    double m_targetCellSize{kDefaultTargetCellSize};
+    int m_maxCells{kDefaultMaxCells};
+    int m_current{-1};
+};
+
+#endif //RESOLUTIONSELECTOR_H
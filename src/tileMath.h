@@ -0,0 +1,34 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef TILEMATH_H
+#define TILEMATH_H
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+// Пересчёт между широтой/долготой и координатами тайлов Web-Mercator (схема XYZ)
+namespace TileMath
+{
+    constexpr double kMaxLatitude = 85.0511287798066;
+
+    inline double lngToTileX(const double lng, const int z) { return (lng + 180.0) / 360.0 * (1 << z); }
+
+    inline double latToTileY(const double lat, const int z)
+    {
+        const double rad = std::clamp(lat, -kMaxLatitude, kMaxLatitude) * std::numbers::pi / 180.0;
+        return (1.0 - std::asinh(std::tan(rad)) / std::numbers::pi) / 2.0 * (1 << z);
+    }
+
+    inline double tileXToLng(const double x, const int z) { return x / (1 << z) * 360.0 - 180.0; }
+
+    inline double tileYToLat(const double y, const int z)
+    {
+        const double n = std::numbers::pi * (1.0 - 2.0 * y / (1 << z));
+        return std::atan(std::sinh(n)) * 180.0 / std::numbers::pi;
+    }
+} // namespace TileMath
+
+#endif //TILEMATH_H
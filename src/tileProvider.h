@@ -0,0 +1,28 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef TILEPROVIDER_H
+#define TILEPROVIDER_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QString>
+
+// Источник тайлов, который раздаёт TileServer
+class TileProvider {
+public:
+    virtual ~TileProvider() = default;
+
+    // Пустой результат - тайла нет (отдаётся 204)
+    virtual QFuture<QByteArray> requestTile(int z, int x, int y) = 0;
+    virtual QByteArray tileJson(const QString &tilesUrl) const = 0;
+
+    virtual QByteArray contentType() const { return "application/x-protobuf"; }
+    virtual QString extension() const { return QStringLiteral("pbf"); }
+
+    // Cache-Control: max-age для тайлов, которые меняются вместе с данными; -1 - заголовок не нужен
+    virtual int maxAge() const { return -1; }
+};
+
+#endif //TILEPROVIDER_H
@@ -0,0 +1,167 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "tileServer.h"
+
+#include <QDebug>
+#include <QUrl>
+
+namespace
+{
+    QByteArray statusText(const int status)
+    {
+        switch (status)
+        {
+        case 200:
+            return "OK";
+        case 204:
+            return "No Content";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        default:
+            return "Internal Server Error";
+        }
+    }
+} // namespace
+
+TileServer::TileServer(QObject* parent) : QObject(parent)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &TileServer::onNewConnection);
+}
+
+TileServer::~TileServer() { m_server.close(); }
+
+bool TileServer::listen(const quint16 port)
+{
+    if (!m_server.listen(QHostAddress::LocalHost, port))
+    {
+        qWarning() << "Tile server failed to listen:" << m_server.errorString();
+        return false;
+    }
+    emit listeningChanged();
+    return true;
+}
+
+void TileServer::addProvider(const QString& name, TileProvider* provider) { m_providers.insert(name, provider); }
+
+QString TileServer::tileJsonUrl(const QString& name) const
+{
+    return QStringLiteral("http://127.0.0.1:%1/%2/tiles.json").arg(m_server.serverPort()).arg(name);
+}
+
+QString TileServer::tilesUrl(const QString& name) const
+{
+    const TileProvider* provider = m_providers.value(name);
+    const QString extension = provider ? provider->extension() : QStringLiteral("pbf");
+    return QStringLiteral("http://127.0.0.1:%1/%2/{z}/{x}/{y}.%3").arg(m_server.serverPort()).arg(name, extension);
+}
+
+void TileServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server.nextPendingConnection())
+    {
+        m_connections.insert(socket, Connection());
+
+        connect(socket, &QTcpSocket::readyRead, this,
+                [this, socket]()
+                {
+                    m_connections[socket].buffer.append(socket->readAll());
+                    processRequests(socket);
+                });
+        connect(socket, &QTcpSocket::disconnected, this,
+                [this, socket]()
+                {
+                    m_connections.remove(socket);
+                    socket->deleteLater();
+                });
+    }
+}
+
+void TileServer::processRequests(QTcpSocket* socket)
+{
+    const auto it = m_connections.find(socket);
+    if (it == m_connections.end() || it->busy)
+        return;
+
+    const qsizetype headerEnd = it->buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+        return;
+
+    const QByteArray requestLine = it->buffer.left(it->buffer.indexOf("\r\n"));
+    it->buffer.remove(0, headerEnd + 4);
+    it->busy = true;
+
+    // Тела запросов не поддерживаем: MapLibre шлёт только GET
+    const QList<QByteArray> parts = requestLine.split(' ');
+    if (parts.size() < 2 || parts[0] != "GET")
+    {
+        finishRequest(socket, 405, "text/plain", {});
+        return;
+    }
+
+    handleRequest(socket, QUrl(QString::fromLatin1(parts[1])).path());
+}
+
+void TileServer::handleRequest(QTcpSocket* socket, const QString& path)
+{
+    // Пути вида /<name>/tiles.json и /<name>/<z>/<x>/<y>.<ext>
+    const QStringList segments = path.split('/', Qt::SkipEmptyParts);
+    TileProvider* provider = segments.isEmpty() ? nullptr : m_providers.value(segments.first());
+
+    if (!provider)
+    {
+        finishRequest(socket, 404, "text/plain", {});
+        return;
+    }
+
+    if (segments.size() == 2 && segments[1] == QLatin1String("tiles.json"))
+    {
+        finishRequest(socket, 200, "application/json", provider->tileJson(tilesUrl(segments.first())));
+        return;
+    }
+
+    bool okZ = false, okX = false, okY = false;
+    const int z = segments.value(1).toInt(&okZ);
+    const int x = segments.value(2).toInt(&okX);
+    const int y = segments.value(3).section('.', 0, 0).toInt(&okY);
+
+    if (segments.size() != 4 || !okZ || !okX || !okY || z < 0 || z > 30)
+    {
+        finishRequest(socket, 404, "text/plain", {});
+        return;
+    }
+
+    const QByteArray contentType = provider->contentType();
+    const int maxAge = provider->maxAge();
+    provider->requestTile(z, x, y).then(socket,
+                                        [this, socket, contentType, maxAge](const QByteArray& tile)
+                                        {
+                                            finishRequest(socket, tile.isEmpty() ? 204 : 200, contentType, tile,
+                                                          maxAge);
+                                        });
+}
+
+void TileServer::finishRequest(QTcpSocket* socket, const int status, const QByteArray& contentType,
+                               const QByteArray& body, const int maxAge)
+{
+    QByteArray response;
+    response.reserve(body.size() + 160);
+    response += "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Access-Control-Allow-Origin: *\r\n";
+    if (maxAge >= 0)
+        response += "Cache-Control: max-age=" + QByteArray::number(maxAge) + "\r\n";
+    response += "Connection: keep-alive\r\n\r\n";
+    response += body;
+    socket->write(response);
+
+    if (const auto it = m_connections.find(socket); it != m_connections.end())
+    {
+        it->busy = false;
+        processRequests(socket);
+    }
+}
@@ -0,0 +1,53 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef TILESERVER_H
+#define TILESERVER_H
+
+#include <QHash>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "tileProvider.h"
+
+// Минимальный HTTP сервер на localhost, через который MapLibre получает тайлы из процесса
+class TileServer : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool listening READ isListening NOTIFY listeningChanged)
+
+public:
+    explicit TileServer(QObject *parent = nullptr);
+    ~TileServer() override;
+
+    bool listen(quint16 port = 0);
+    bool isListening() const { return m_server.isListening(); }
+
+    void addProvider(const QString &name, TileProvider *provider);
+
+    QString tileJsonUrl(const QString &name) const;
+    // Шаблон адреса тайлов для источников, которые QML добавляет в стиль карты
+    Q_INVOKABLE QString tilesUrl(const QString &name) const;
+
+signals:
+    void listeningChanged();
+
+private:
+    struct Connection {
+        QByteArray buffer;
+        bool busy{false}; // Ответы отдаём строго по порядку запросов
+    };
+
+    void onNewConnection();
+    void processRequests(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const QString &path);
+    void finishRequest(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body,
+                       int maxAge = -1);
+
+    QTcpServer m_server;
+    QHash<QString, TileProvider *> m_providers;
+    QHash<QTcpSocket *, Connection> m_connections;
+};
+
+#endif //TILESERVER_H
@@ -0,0 +1,112 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "typedArrays.h"
+
+#include <QVariant>
+
+#include <cstring>
+
+namespace
+{
+    template <typename T>
+    void copyElements(const QByteArray& data, const size_t count, std::vector<double>& out)
+    {
+        out.resize(count);
+        const char* source = data.constData();
+        for (size_t i = 0; i < count; ++i)
+        {
+            T value;
+            std::memcpy(&value, source + i * sizeof(T), sizeof(T));
+            out[i] = static_cast<double>(value);
+        }
+    }
+} // namespace
+
+namespace TypedArrays
+{
+    bool bytes(const QJSValue& array, QByteArray& data, int& elementSize)
+    {
+        // ArrayBuffer приходит в C++ как QByteArray
+        const QVariant direct = array.toVariant();
+        if (direct.typeId() == QMetaType::QByteArray)
+        {
+            data = direct.toByteArray();
+            elementSize = 0;
+            return true;
+        }
+
+        // Представление (Uint32Array, Float32Array, ...) над буфером
+        const QJSValue buffer = array.property(QStringLiteral("buffer"));
+        const QVariant raw = buffer.toVariant();
+        if (raw.typeId() != QMetaType::QByteArray)
+            return false;
+
+        const QByteArray whole = raw.toByteArray();
+        const qsizetype offset = array.property(QStringLiteral("byteOffset")).toInt();
+        const qsizetype length = array.property(QStringLiteral("byteLength")).toInt();
+        if (offset < 0 || length < 0 || offset + length > whole.size())
+            return false;
+
+        data = offset == 0 && length == whole.size() ? whole : whole.mid(offset, length);
+        elementSize = array.property(QStringLiteral("BYTES_PER_ELEMENT")).toInt();
+        return true;
+    }
+
+    bool readIndices(const QJSValue& high, const QJSValue& low, std::vector<H3Index>& indices)
+    {
+        QByteArray highBytes;
+        QByteArray lowBytes;
+        int highSize = 0;
+        int lowSize = 0;
+        if (!bytes(high, highBytes, highSize) || !bytes(low, lowBytes, lowSize))
+            return false;
+        if ((highSize != 0 && highSize != 4) || (lowSize != 0 && lowSize != 4) || highBytes.size() != lowBytes.size())
+            return false;
+
+        const size_t count = highBytes.size() / sizeof(quint32);
+        indices.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            quint32 hi;
+            quint32 lo;
+            std::memcpy(&hi, highBytes.constData() + i * sizeof(quint32), sizeof(quint32));
+            std::memcpy(&lo, lowBytes.constData() + i * sizeof(quint32), sizeof(quint32));
+            indices[i] = (static_cast<H3Index>(hi) << 32) | lo;
+        }
+        return true;
+    }
+
+    bool readValues(const QJSValue& values, const size_t count, std::vector<double>& out)
+    {
+        QByteArray data;
+        int elementSize = 0;
+        if (!bytes(values, data, elementSize))
+            return false;
+
+        // Пустой пакет - не ошибка
+        if (count == 0)
+        {
+            out.clear();
+            return true;
+        }
+
+        if (elementSize == 0)
+            elementSize = static_cast<int>(data.size() / static_cast<qsizetype>(count));
+        if (static_cast<size_t>(data.size()) < count * elementSize)
+            return false;
+
+        switch (elementSize)
+        {
+        case sizeof(float):
+            copyElements<float>(data, count, out);
+            return true;
+        case sizeof(double):
+            copyElements<double>(data, count, out);
+            return true;
+        default:
+            return false;
+        }
+    }
+} // namespace TypedArrays
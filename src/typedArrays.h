@@ -0,0 +1,29 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef TYPEDARRAYS_H
+#define TYPEDARRAYS_H
+
+#include <QByteArray>
+#include <QJSValue>
+
+#include <h3api.h>
+
+#include <vector>
+
+// Чтение типизированных массивов JS (и голых ArrayBuffer) из Q_INVOKABLE методов: берём буфер целиком
+// как QByteArray и разбираем байты, без QVariant и QString на каждый элемент
+namespace TypedArrays
+{
+    // Байты содержимого с учётом byteOffset/byteLength. elementSize - BYTES_PER_ELEMENT (0 для ArrayBuffer)
+    bool bytes(const QJSValue &array, QByteArray &data, int &elementSize);
+
+    // Индексы из пары Uint32Array: старшие и младшие 32 бита
+    bool readIndices(const QJSValue &high, const QJSValue &low, std::vector<H3Index> &indices);
+
+    // Float32Array или Float64Array (для ArrayBuffer тип определяется по размеру на count элементов)
+    bool readValues(const QJSValue &values, size_t count, std::vector<double> &out);
+} // namespace TypedArrays
+
+#endif //TYPEDARRAYS_H
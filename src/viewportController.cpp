@@ -0,0 +1,303 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "viewportController.h"
+
+#include <QQuickWindow>
+
+#include <algorithm>
+#include <cmath>
+
+#include "instrumentation.h"
+
+namespace
+{
+    constexpr double kVelocitySmoothing = 0.3;      // Вес нового замера скорости
+    constexpr qint64 kGestureGapNs = 200'000'000;  // Пауза дольше - движение остановилось
+    constexpr double kFrameNs = 16'666'667.0;
+    constexpr double kMargin = 0.05;      // Запас со всех сторон, чтобы дрожание камеры не вызывало пересчёт
+    constexpr double kMaxPrefetch = 0.5;  // Дополнение по направлению движения, доля размера окна
+    constexpr double kComputeSmoothing = 0.25;
+    constexpr int kHorizonSteps = 16;
+    constexpr double kRetryShrink = 0.8; // Во сколько раз должна уменьшиться область, чтобы повторить отказ
+
+    double wrapLongitude(double delta)
+    {
+        while (delta > 180.0)
+            delta -= 360.0;
+        while (delta < -180.0)
+            delta += 360.0;
+        return delta;
+    }
+} // namespace
+
+ViewportController::ViewportController(QObject* parent) : QObject(parent)
+{
+    m_clock.start();
+
+    m_throttleTimer.setSingleShot(true);
+    connect(&m_throttleTimer, &QTimer::timeout, this, &ViewportController::sample);
+}
+
+void ViewportController::setMap(QQuickItem* map)
+{
+    if (m_map == map)
+        return;
+
+    if (m_map)
+        disconnect(m_map, nullptr, this, nullptr);
+
+    m_map = map;
+    attachWindow(m_map ? m_map->window() : nullptr);
+    if (m_map)
+        connect(m_map, &QQuickItem::windowChanged, this, &ViewportController::attachWindow);
+
+    emit mapChanged();
+}
+
+void ViewportController::setModel(H3HexagonModel* model)
+{
+    if (m_model == model)
+        return;
+
+    if (m_model)
+        disconnect(m_model, nullptr, this, nullptr);
+
+    m_model = model;
+    m_inFlight = false;
+    m_rejectedResolution = -1;
+    resetCoverage();
+
+    if (m_model)
+    {
+        connect(m_model, &H3HexagonModel::updateFinished, this, &ViewportController::onUpdateFinished);
+        connect(m_model, &H3HexagonModel::updateCancelled, this, &ViewportController::onUpdateCancelled);
+
+        // Смена целевого размера ячейки меняет разрешение без движения камеры
+        connect(m_model, &H3HexagonModel::targetCellSizeChanged, this, &ViewportController::sample);
+        connect(m_model, &H3HexagonModel::adaptiveResolutionChanged, this, &ViewportController::sample);
+    }
+
+    emit modelChanged();
+}
+
+void ViewportController::setEnabled(const bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+
+    m_enabled = enabled;
+    emit enabledChanged();
+
+    if (m_enabled)
+        sample();
+}
+
+void ViewportController::attachWindow(QQuickWindow* window)
+{
+    if (m_window == window)
+        return;
+
+    disconnect(m_frameConnection);
+    m_window = window;
+
+    // afterAnimating приходит в потоке GUI перед синхронизацией каждого кадра
+    if (m_window)
+        m_frameConnection = connect(m_window, &QQuickWindow::afterAnimating, this, &ViewportController::sample);
+}
+
+void ViewportController::sample()
+{
+    if (!m_enabled || !m_map || !m_model || m_map->width() <= 0 || m_map->height() <= 0)
+        return;
+
+    const ViewportGeometry::GeoRing visible = visibleRing();
+    if (visible.size() < 3)
+        return;
+
+    const ViewportGeometry::GeoPoint center = ViewportGeometry::centroid(visible);
+    const double zoom = m_map->property("zoomLevel").toDouble();
+    const qint64 now = m_clock.nsecsElapsed();
+
+    // Скорость центра: экспоненциальное сглаживание, сброс после паузы в жесте
+    if (m_lastSampleNs >= 0 && now > m_lastSampleNs)
+    {
+        const qint64 dt = now - m_lastSampleNs;
+        if (dt > kGestureGapNs)
+        {
+            m_velocityLat = 0.0;
+            m_velocityLng = 0.0;
+        }
+        else
+        {
+            const double seconds = dt / 1e9;
+            const double lat = (center.lat - m_lastCenter.lat) / seconds;
+            const double lng = wrapLongitude(center.lng - m_lastCenter.lng) / seconds;
+            m_velocityLat += kVelocitySmoothing * (lat - m_velocityLat);
+            m_velocityLng += kVelocitySmoothing * (lng - m_velocityLng);
+        }
+    }
+    m_lastCenter = center;
+    m_lastSampleNs = now;
+
+    const qreal devicePixelRatio = m_window ? m_window->effectiveDevicePixelRatio() : 1.0;
+    const int resolution =
+        m_model->selectResolution(zoom, center.lat, devicePixelRatio, QSizeF(m_map->width(), m_map->height()));
+    if (resolution == m_coveredResolution && ViewportGeometry::containsRing(m_covered, visible))
+    {
+        m_firstDirtyNs = -1;
+        return;
+    }
+
+    // Отказ по лимиту ячеек повторяем, только когда камера ушла из отклонённой области или вид заметно сжался
+    if (!m_inFlight && resolution == m_rejectedResolution && ViewportGeometry::containsRing(m_rejected, visible) &&
+        ViewportGeometry::width(visible) * ViewportGeometry::height(visible) > m_rejectedArea * kRetryShrink)
+    {
+        return;
+    }
+
+    if (m_firstDirtyNs < 0)
+        m_firstDirtyNs = now;
+
+    if (m_inFlight && resolution == m_requestedResolution)
+    {
+        // Текущий расчёт и так покроет экран - ждём его
+        if (ViewportGeometry::containsRing(m_requested, visible))
+            return;
+
+        // Не чаще, чем успевает считаться: иначе каждый запрос отменит предыдущий и ни один не завершится
+        const qint64 remaining = static_cast<qint64>(m_computeEmaNs) - (now - m_issuedNs);
+        if (remaining > 0)
+        {
+            if (!m_throttleTimer.isActive())
+                m_throttleTimer.start(static_cast<int>(std::ceil(remaining / 1e6)));
+            return;
+        }
+    }
+
+    issue(visible, zoom, resolution, now);
+}
+
+void ViewportController::issue(const ViewportGeometry::GeoRing& visible, const double zoom, const int resolution,
+                               const qint64 now)
+{
+    m_throttleTimer.stop();
+
+    m_requested = predictedRing(visible);
+    m_requestedResolution = resolution;
+    m_requestedArea = ViewportGeometry::width(visible) * ViewportGeometry::height(visible);
+    m_inFlight = true;
+    m_issuedNs = now;
+
+    if (m_firstDirtyNs >= 0)
+        Instrumentation::instance().recordStage(Stage::Schedule, now - m_firstDirtyNs);
+    m_firstDirtyNs = -1;
+
+    m_requestGeneration = m_model->updateViewportAsync(m_requested, zoom, resolution);
+}
+
+void ViewportController::onUpdateFinished()
+{
+    // Модель пересчитали в обход контроллера: её ячейки не соответствуют m_covered. Наш запрос при этом
+    // вытеснен и придёт как updateCancelled
+    if (!m_inFlight || m_model->updateGeneration() != m_requestGeneration)
+    {
+        resetCoverage();
+        return;
+    }
+
+    const double computeNs = m_clock.nsecsElapsed() - m_issuedNs;
+    m_computeEmaNs = m_computeEmaNs > 0 ? m_computeEmaNs + kComputeSmoothing * (computeNs - m_computeEmaNs)
+                                        : computeNs;
+    emit statisticsChanged();
+
+    m_inFlight = false;
+    if (m_model->truncated())
+    {
+        // Ячеек больше лимита - модель пуста, область не покрыта
+        resetCoverage();
+        m_rejected = m_requested;
+        m_rejectedResolution = m_requestedResolution;
+        m_rejectedArea = m_requestedArea;
+    }
+    else
+    {
+        m_covered = m_requested;
+        m_coveredResolution = m_requestedResolution;
+        m_rejected.clear();
+        m_rejectedResolution = -1;
+    }
+
+    // Пока считали, камера могла уйти дальше
+    sample();
+}
+
+void ViewportController::onUpdateCancelled()
+{
+    // Отменён предыдущий запрос, вытесненный нашим следующим, - ждём следующий
+    if (!m_inFlight || m_model->updateGeneration() == m_requestGeneration)
+        return;
+
+    m_inFlight = false;
+    sample();
+}
+
+void ViewportController::resetCoverage()
+{
+    m_covered.clear();
+    m_coveredResolution = -1;
+}
+
+ViewportGeometry::GeoRing ViewportController::visibleRing() const
+{
+    const double width = m_map->width();
+    const double height = m_map->height();
+
+    // При наклоне верх экрана может смотреть выше горизонта - спускаемся до первой строки, что видит землю.
+    // Получается трапеция видимой области вместо четырёх углов экрана
+    double top = 0.0;
+    QGeoCoordinate topLeft;
+    QGeoCoordinate topRight;
+    for (int step = 0; step < kHorizonSteps; ++step)
+    {
+        top = height * step / kHorizonSteps;
+        topLeft = mapCoordinate(QPointF(0, top));
+        topRight = mapCoordinate(QPointF(width, top));
+        if (topLeft.isValid() && topRight.isValid())
+            break;
+    }
+
+    return ViewportGeometry::fromCorners(
+        {topLeft, topRight, mapCoordinate(QPointF(width, height)), mapCoordinate(QPointF(0, height))});
+}
+
+ViewportGeometry::GeoRing ViewportController::predictedRing(const ViewportGeometry::GeoRing& visible) const
+{
+    const double width = ViewportGeometry::width(visible);
+    const double height = ViewportGeometry::height(visible);
+
+    // Сдвиг за время расчёта и пару кадров, но не больше половины окна
+    const double lookahead = (m_computeEmaNs + 2 * kFrameNs) / 1e9;
+    const double dx = std::clamp(m_velocityLng * lookahead, -width * kMaxPrefetch, width * kMaxPrefetch);
+    const double dy = std::clamp(m_velocityLat * lookahead, -height * kMaxPrefetch, height * kMaxPrefetch);
+
+    // Оболочка текущей и сдвинутой области - и видимое, и то, куда движется камера
+    ViewportGeometry::GeoRing points = visible;
+    if (dx != 0.0 || dy != 0.0)
+    {
+        const ViewportGeometry::GeoRing ahead = ViewportGeometry::translated(visible, dy, dx);
+        points.insert(points.end(), ahead.begin(), ahead.end());
+    }
+
+    return ViewportGeometry::expanded(ViewportGeometry::convexHull(std::move(points)), kMargin);
+}
+
+QGeoCoordinate ViewportController::mapCoordinate(const QPointF& position) const
+{
+    // Map::toCoordinate доступен только через метаобъект QML типа
+    QGeoCoordinate coordinate;
+    QMetaObject::invokeMethod(m_map, "toCoordinate", Q_RETURN_ARG(QGeoCoordinate, coordinate),
+                              Q_ARG(QPointF, position), Q_ARG(bool, false));
+    return coordinate;
+}
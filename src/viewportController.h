@@ -0,0 +1,89 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef VIEWPORTCONTROLLER_H
+#define VIEWPORTCONTROLLER_H
+
+#include <QElapsedTimer>
+#include <QGeoCoordinate>
+#include <QObject>
+#include <QPointer>
+#include <QQuickItem>
+#include <QTimer>
+
+#include "h3model.h"
+#include "viewportGeometry.h"
+
+// Обновление гексагонов по кадрам вместо фиксированного debounce: камера опрашивается на каждом кадре,
+// расчёт запускается сразу и отменяется следующим, область дополняется по направлению движения,
+// а частота запросов ограничивается измеренным временем расчёта
+class ViewportController : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QQuickItem *map READ map WRITE setMap NOTIFY mapChanged)
+    Q_PROPERTY(H3HexagonModel *model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(double computeTimeMs READ computeTimeMs NOTIFY statisticsChanged)
+
+public:
+    explicit ViewportController(QObject *parent = nullptr);
+
+    QQuickItem *map() const { return m_map; }
+    void setMap(QQuickItem *map);
+
+    H3HexagonModel *model() const { return m_model; }
+    void setModel(H3HexagonModel *model);
+
+    bool enabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    double computeTimeMs() const { return m_computeEmaNs / 1e6; }
+
+signals:
+    void mapChanged();
+    void modelChanged();
+    void enabledChanged();
+    void statisticsChanged();
+
+private:
+    void attachWindow(QQuickWindow *window);
+    void sample();
+    void issue(const ViewportGeometry::GeoRing &visible, double zoom, int resolution, qint64 now);
+    void onUpdateFinished();
+    void onUpdateCancelled();
+    void resetCoverage();
+    ViewportGeometry::GeoRing visibleRing() const;
+    ViewportGeometry::GeoRing predictedRing(const ViewportGeometry::GeoRing &visible) const;
+    QGeoCoordinate mapCoordinate(const QPointF &position) const;
+
+    QPointer<QQuickItem> m_map;
+    QPointer<H3HexagonModel> m_model;
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_frameConnection;
+    bool m_enabled{true};
+
+    QElapsedTimer m_clock;
+    QTimer m_throttleTimer; // Повторный опрос, когда запрос отложен, а новых кадров может не быть
+
+    // Скорость центра камеры, градусы в секунду (сглаженная)
+    ViewportGeometry::GeoPoint m_lastCenter{0.0, 0.0};
+    qint64 m_lastSampleNs{-1};
+    double m_velocityLat{0.0};
+    double m_velocityLng{0.0};
+
+    ViewportGeometry::GeoRing m_covered; // Область, для которой гексагоны уже в модели
+    int m_coveredResolution{-1};
+    ViewportGeometry::GeoRing m_requested; // Область текущего расчёта
+    int m_requestedResolution{-1};
+    double m_requestedArea{0.0}; // Размер видимой области на момент запроса, градусы²
+    quint64 m_requestGeneration{0};
+    bool m_inFlight{false};
+    ViewportGeometry::GeoRing m_rejected; // Запрос, упёршийся в лимит ячеек
+    int m_rejectedResolution{-1};
+    double m_rejectedArea{0.0};
+    qint64 m_issuedNs{0};
+    qint64 m_firstDirtyNs{-1}; // Когда камера впервые вышла за m_covered
+    double m_computeEmaNs{0.0};
+};
+
+#endif //VIEWPORTCONTROLLER_H
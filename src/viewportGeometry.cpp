@@ -0,0 +1,256 @@
+//
+// Created by user on 10/18/26.
+//
+
+#include "viewportGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ViewportGeometry
+{
+    namespace
+    {
+        constexpr double kMaxLatitude = 89.999;
+
+        double unwrapNear(double lng, const double reference)
+        {
+            while (lng - reference > 180.0)
+                lng -= 360.0;
+            while (lng - reference < -180.0)
+                lng += 360.0;
+            return lng;
+        }
+
+        double cross(const GeoPoint &o, const GeoPoint &a, const GeoPoint &b)
+        {
+            return (a.lng - o.lng) * (b.lat - o.lat) - (a.lat - o.lat) * (b.lng - o.lng);
+        }
+
+        // Отсечение Сазерленда-Ходжмана вертикальной прямой lng = bound
+        GeoRing clip(const GeoRing &ring, const double bound, const bool keepGreater)
+        {
+            GeoRing result;
+            const auto inside = [&](const GeoPoint &p) { return keepGreater ? p.lng >= bound : p.lng <= bound; };
+
+            for (size_t i = 0; i < ring.size(); ++i)
+            {
+                const GeoPoint &current = ring[i];
+                const GeoPoint &previous = ring[(i + ring.size() - 1) % ring.size()];
+
+                if (inside(current) != inside(previous))
+                {
+                    const double t = (bound - previous.lng) / (current.lng - previous.lng);
+                    result.push_back({previous.lat + (current.lat - previous.lat) * t, bound});
+                }
+                if (inside(current))
+                    result.push_back(current);
+            }
+            return result;
+        }
+    } // namespace
+
+    GeoRing fromCorners(const QList<QGeoCoordinate> &corners)
+    {
+        GeoRing ring;
+        ring.reserve(corners.size());
+        for (const QGeoCoordinate &corner : corners)
+        {
+            if (!corner.isValid())
+                continue;
+
+            const double lng = ring.empty() ? corner.longitude() : unwrapNear(corner.longitude(), ring.back().lng);
+            ring.push_back({corner.latitude(), lng});
+        }
+        return ring;
+    }
+
+    GeoRing fromRectangle(const QGeoRectangle &rectangle)
+    {
+        if (!rectangle.isValid() || rectangle.isEmpty())
+            return {};
+
+        const double north = rectangle.topLeft().latitude();
+        const double south = rectangle.bottomRight().latitude();
+        const double west = rectangle.topLeft().longitude();
+        double east = rectangle.bottomRight().longitude();
+        if (east < west)
+            east += 360.0; // Прямоугольник пересекает антимеридиан
+
+        return {{north, west}, {north, east}, {south, east}, {south, west}};
+    }
+
+    GeoRing expanded(const GeoRing &ring, const double margin)
+    {
+        if (ring.empty() || margin == 0.0)
+            return ring;
+
+        const GeoPoint center = centroid(ring);
+        GeoRing result;
+        result.reserve(ring.size());
+        for (const GeoPoint &point : ring)
+        {
+            result.push_back({std::clamp(center.lat + (point.lat - center.lat) * (1.0 + margin), -kMaxLatitude,
+                                         kMaxLatitude),
+                              center.lng + (point.lng - center.lng) * (1.0 + margin)});
+        }
+        return result;
+    }
+
+    GeoRing translated(const GeoRing &ring, const double dLat, const double dLng)
+    {
+        GeoRing result;
+        result.reserve(ring.size());
+        for (const GeoPoint &point : ring)
+            result.push_back({std::clamp(point.lat + dLat, -kMaxLatitude, kMaxLatitude), point.lng + dLng});
+        return result;
+    }
+
+    GeoRing convexHull(GeoRing points)
+    {
+        // Монотонная цепь Эндрю; результат - против часовой стрелки в осях (lng, lat)
+        if (points.size() < 3)
+            return points;
+
+        std::sort(points.begin(), points.end(),
+                  [](const GeoPoint &a, const GeoPoint &b) { return a.lng < b.lng || (a.lng == b.lng && a.lat < b.lat); });
+
+        GeoRing hull(points.size() * 2);
+        size_t k = 0;
+        for (const GeoPoint &point : points)
+        {
+            while (k >= 2 && cross(hull[k - 2], hull[k - 1], point) <= 0)
+                --k;
+            hull[k++] = point;
+        }
+        for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;)
+        {
+            while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i]) <= 0)
+                --k;
+            hull[k++] = points[i];
+        }
+        hull.resize(k - 1);
+        return hull;
+    }
+
+    GeoPoint centroid(const GeoRing &ring)
+    {
+        GeoPoint center{0.0, 0.0};
+        if (ring.empty())
+            return center;
+
+        for (const GeoPoint &point : ring)
+        {
+            center.lat += point.lat;
+            center.lng += point.lng;
+        }
+        center.lat /= ring.size();
+        center.lng /= ring.size();
+        return center;
+    }
+
+    double width(const GeoRing &ring)
+    {
+        if (ring.empty())
+            return 0.0;
+        const auto [min, max] = std::minmax_element(ring.begin(), ring.end(),
+                                                    [](const GeoPoint &a, const GeoPoint &b) { return a.lng < b.lng; });
+        return max->lng - min->lng;
+    }
+
+    double height(const GeoRing &ring)
+    {
+        if (ring.empty())
+            return 0.0;
+        const auto [min, max] = std::minmax_element(ring.begin(), ring.end(),
+                                                    [](const GeoPoint &a, const GeoPoint &b) { return a.lat < b.lat; });
+        return max->lat - min->lat;
+    }
+
+    bool contains(const GeoRing &ring, const GeoPoint &point)
+    {
+        if (ring.size() < 3)
+            return false;
+
+        // Точку проверяем во всех трёх "копиях" мира, кольцо могло быть развёрнуто в любую сторону
+        for (const double shift : {0.0, -360.0, 360.0})
+        {
+            const double lng = point.lng + shift;
+            bool inside = false;
+            for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+            {
+                const GeoPoint &a = ring[i];
+                const GeoPoint &b = ring[j];
+                if ((a.lat > point.lat) != (b.lat > point.lat) &&
+                    lng < (b.lng - a.lng) * (point.lat - a.lat) / (b.lat - a.lat) + a.lng)
+                {
+                    inside = !inside;
+                }
+            }
+            if (inside)
+                return true;
+        }
+        return false;
+    }
+
+    bool containsRing(const GeoRing &outer, const GeoRing &inner)
+    {
+        // Для выпуклого внешнего кольца достаточно проверить вершины
+        if (inner.empty())
+            return false;
+        return std::all_of(inner.begin(), inner.end(), [&outer](const GeoPoint &point) { return contains(outer, point); });
+    }
+
+    QGeoRectangle boundingRectangle(const GeoRing &ring)
+    {
+        if (ring.empty())
+            return {};
+
+        double north = -90.0;
+        double south = 90.0;
+        double west = ring.front().lng;
+        double east = ring.front().lng;
+        for (const GeoPoint &point : ring)
+        {
+            north = std::max(north, point.lat);
+            south = std::min(south, point.lat);
+            west = std::min(west, point.lng);
+            east = std::max(east, point.lng);
+        }
+
+        if (east - west >= 360.0)
+            return QGeoRectangle(QGeoCoordinate(north, -180.0), QGeoCoordinate(south, 180.0));
+
+        // Сворачиваем обратно в [-180, 180]; при пересечении антимеридиана west окажется больше east
+        return QGeoRectangle(QGeoCoordinate(north, unwrapNear(west, 0.0)), QGeoCoordinate(south, unwrapNear(east, 0.0)));
+    }
+
+    std::vector<GeoRing> splitForPolyfill(const GeoRing &ring, const double maxWidth)
+    {
+        std::vector<GeoRing> pieces;
+        if (ring.size() < 3)
+            return pieces;
+
+        double west = ring.front().lng;
+        double east = ring.front().lng;
+        for (const GeoPoint &point : ring)
+        {
+            west = std::min(west, point.lng);
+            east = std::max(east, point.lng);
+        }
+
+        // Границы полос кратны maxWidth (делитель 180), поэтому полоса никогда не пересекает антимеридиан
+        for (double left = std::floor(west / maxWidth) * maxWidth; left < east; left += maxWidth)
+        {
+            GeoRing piece = clip(clip(ring, left, true), left + maxWidth, false);
+            if (piece.size() < 3)
+                continue;
+
+            const double shift = -360.0 * std::floor((left + 180.0) / 360.0);
+            for (GeoPoint &point : piece)
+                point.lng += shift;
+            pieces.push_back(std::move(piece));
+        }
+        return pieces;
+    }
+} // namespace ViewportGeometry
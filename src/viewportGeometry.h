@@ -0,0 +1,49 @@
+//
+// Created by user on 10/18/26.
+//
+
+#ifndef VIEWPORTGEOMETRY_H
+#define VIEWPORTGEOMETRY_H
+
+#include <QGeoCoordinate>
+#include <QGeoRectangle>
+#include <QList>
+
+#include <vector>
+
+// Многоугольник видимой области в градусах. Долготы "развёрнуты" - идут непрерывно и могут выходить
+// за ±180, поэтому область через антимеридиан остаётся одним выпуклым многоугольником
+namespace ViewportGeometry
+{
+    struct GeoPoint {
+        double lat;
+        double lng;
+    };
+
+    using GeoRing = std::vector<GeoPoint>;
+
+    // Углы экрана по порядку обхода; долготы разворачиваются относительно первого угла
+    GeoRing fromCorners(const QList<QGeoCoordinate> &corners);
+    GeoRing fromRectangle(const QGeoRectangle &rectangle);
+
+    // Увеличение относительно центра масс вершин: margin 0.1 - на 10% в каждую сторону
+    GeoRing expanded(const GeoRing &ring, double margin);
+    GeoRing translated(const GeoRing &ring, double dLat, double dLng);
+    GeoRing convexHull(GeoRing points);
+
+    GeoPoint centroid(const GeoRing &ring);
+    double width(const GeoRing &ring);
+    double height(const GeoRing &ring);
+
+    bool contains(const GeoRing &ring, const GeoPoint &point);
+    bool containsRing(const GeoRing &outer, const GeoRing &inner);
+
+    // Ограничивающий прямоугольник с долготами в [-180, 180] (для подложки и свойства viewport)
+    QGeoRectangle boundingRectangle(const GeoRing &ring);
+
+    // Нарезка на полосы не шире maxWidth, каждая сдвинута в [-180, 180]: H3 считает ребро длиннее 180°
+    // пересекающим антимеридиан, поэтому широкие и "развёрнутые" многоугольники отдаём частями
+    std::vector<GeoRing> splitForPolyfill(const GeoRing &ring, double maxWidth = 90.0);
+} // namespace ViewportGeometry
+
+#endif //VIEWPORTGEOMETRY_H
@@ -0,0 +1,155 @@
+import QtQuick
+import QtQuick.Controls
+
+// Оверлей производительности: гистограммы этапов, кеши, память; данные - perfMetrics из C++
+Rectangle {
+    id: hud
+
+    property int hexagonCount: 0
+    property var delegatePool: null
+
+    width: 320
+    height: hudColumn.height + 20
+    color: "#D0202020"
+    radius: 5
+
+    function formatBytes(bytes) {
+        if (bytes < 0)
+            return "n/a"
+        if (bytes < 1024 * 1024)
+            return (bytes / 1024).toFixed(0) + " KiB"
+        return (bytes / (1024 * 1024)).toFixed(1) + " MiB"
+    }
+
+    function bucketLabel(index) {
+        let bounds = perfMetrics.histogramBounds
+        if (index >= bounds.length)
+            return ">" + bounds[bounds.length - 1] + " ms"
+        return "<" + bounds[index] + " ms"
+    }
+
+    Column {
+        id: hudColumn
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
+        anchors.margins: 10
+        spacing: 4
+
+        Text {
+            text: "Performance"
+            color: "white"
+            font.bold: true
+            font.pixelSize: 14
+        }
+
+        Text {
+            visible: !perfMetrics.enabled
+            color: "#C0C0C0"
+            font.pixelSize: 11
+            text: "Built without H3VIEWER_INSTRUMENTATION"
+        }
+
+        Text {
+            color: "white"
+            font.pixelSize: 11
+            text: "Cells: " + hud.hexagonCount + "    Heap: " + hud.formatBytes(perfMetrics.allocatedBytes)
+        }
+
+        Text {
+            visible: hud.delegatePool !== null
+            color: "white"
+            font.pixelSize: 11
+            text: hud.delegatePool ? "Delegates: " + hud.delegatePool.activeCount + " / pool " + hud.delegatePool.poolSize
+                                     + "    reuse: " + (hud.delegatePool.reuseRate * 100).toFixed(1) + "%" : ""
+        }
+
+        // Строка на этап: последние/средние/максимальные миллисекунды и гистограмма
+        Repeater {
+            model: perfMetrics.stages
+
+            Column {
+                width: hudColumn.width
+                spacing: 1
+
+                property var stage: modelData
+                property real peak: Math.max.apply(null, stage.histogram.concat([1]))
+
+                Text {
+                    color: "white"
+                    font.pixelSize: 11
+                    text: stage.name + ": " + stage.lastMs.toFixed(2) + " ms  avg " + stage.avgMs.toFixed(2)
+                          + "  max " + stage.maxMs.toFixed(2) + "  n=" + stage.count
+                }
+
+                Row {
+                    spacing: 1
+                    height: 16
+
+                    Repeater {
+                        model: stage.histogram
+
+                        Rectangle {
+                            width: (hudColumn.width - (stage.histogram.length - 1)) / stage.histogram.length
+                            height: Math.max(1, 16 * modelData / peak)
+                            anchors.bottom: parent.bottom
+                            color: modelData > 0 ? "#4FC3F7" : "#40FFFFFF"
+
+                            HoverHandler {
+                                id: bucketHover
+                            }
+
+                            ToolTip.visible: bucketHover.hovered
+                            ToolTip.text: hud.bucketLabel(index) + ": " + modelData
+                        }
+                    }
+                }
+            }
+        }
+
+        Text {
+            color: "white"
+            font.pixelSize: 11
+            font.bold: true
+            text: "Caches"
+        }
+
+        Repeater {
+            model: perfMetrics.caches
+
+            Text {
+                color: "white"
+                font.pixelSize: 11
+                text: modelData.name + ": " + (modelData.hitRate * 100).toFixed(1) + "% ("
+                      + modelData.hits + " / " + (modelData.hits + modelData.misses) + ")"
+            }
+        }
+
+        Text {
+            visible: perfMetrics.queues.length > 0
+            color: "white"
+            font.pixelSize: 11
+            font.bold: true
+            text: "Task queues"
+        }
+
+        Repeater {
+            model: perfMetrics.queues
+
+            Text {
+                color: "white"
+                font.pixelSize: 11
+                text: modelData.name + ": " + modelData.queued + " queued, " + modelData.running + "/"
+                      + modelData.limit + " running, wait " + modelData.avgWaitMs.toFixed(2) + " / "
+                      + modelData.maxWaitMs.toFixed(2) + " ms"
+            }
+        }
+
+        Text {
+            color: "#C0C0C0"
+            font.pixelSize: 11
+            text: "Updates: " + (perfMetrics.counters.updates || 0)
+                  + "  rejected: " + (perfMetrics.counters.viewportsRejected || 0)
+        }
+    }
+}
@@ -24,41 +24,35 @@ ApplicationWindow {
     // Модель и менеджер данных
     H3HexagonModel {
         id: h3Model
-        zoom: map.zoomLevel
+        objectName: "h3Model"
         onH3ResolutionChanged: {
             console.log("H3 resolution changed to:", h3Resolution)
         }
-    }
-
-    // Функция для обновления viewport
-    function updateViewport() {
-        if (!map.mapReady) {
-            console.log("Map not ready yet")
-            return;
+        // Предзагрузка тайлов подложки по направлению движения
+        onViewportChanged: {
+            if (tileSource) tileSource.updateViewport(viewport, zoom)
         }
+        Component.onCompleted: perfMetrics.trackModel(h3Model)
+    }
 
-        // Вычисляем размер видимой области в градусах
-        let topLeft = map.toCoordinate(Qt.point(0, 0));
-        let bottomRight = map.toCoordinate(Qt.point(map.width, map.height));
-
-        console.log("Calculating viewport - TL:", topLeft, "BR:", bottomRight)
-
-        if (topLeft.isValid && bottomRight.isValid) {
-            let widthDegrees = Math.abs(bottomRight.longitude - topLeft.longitude);
-            let heightDegrees = Math.abs(topLeft.latitude - bottomRight.latitude);
-
-            console.log("Viewport size:", widthDegrees, "x", heightDegrees, "degrees")
+    // Слои данных поверх общей сетки: свои значения, шкала и видимость, ячейки не пересчитываются
+    H3LayerManager {
+        id: layerManager
+        tessellation: h3Model
+    }
 
-            h3Model.setViewportFromCenter(map.center, widthDegrees, heightDegrees);
-        }
+    // Опрос камеры на каждом кадре и асинхронный пересчёт гексагонов
+    ViewportController {
+        id: viewportController
+        map: map
+        model: h3Model
+        enabled: map.mapReady
     }
 
-    // Таймер для обновления viewport
-    Timer {
-        id: viewportUpdateTimer
-        interval: 250
-        repeat: false
-        onTriggered: updateViewport()
+    // Оверлей производительности
+    Shortcut {
+        sequence: "F3"
+        onActivated: perfHud.visible = !perfHud.visible
     }
 
     // Основной интерфейс
@@ -85,6 +79,7 @@ ApplicationWindow {
 
             Map {
                 id: map
+                objectName: "map"
 
                 anchors.fill: parent
 
@@ -107,30 +102,155 @@ ApplicationWindow {
                     id: mapReadyTimer
                     interval: 250
                     repeat: false
-                    onTriggered: {
-                        map.mapReady = true
-                        updateViewport()
-                    }
-                }
-
-                onCenterChanged: {
-                    if (mapReady) viewportUpdateTimer.restart()
+                    onTriggered: map.mapReady = true
                 }
 
                 onZoomLevelChanged: {
                     if (map.zoomLevel <= 4) {
                         map.zoomLevel = 4;
                     }
-                    h3Model.zoom = map.zoomLevel
-                    if (mapReady) viewportUpdateTimer.restart()
                 }
 
-                onWidthChanged: {
-                    if (mapReady && width > 0) viewportUpdateTimer.restart()
+                // Оверлеи из локального сервера тайлов добавляются в стиль во время работы. Выключенный
+                // оверлей скрыт через visibility слоя, и его тайлы MapLibre не запрашивает
+                MapLibre.style: Style {
+                    id: mapStyle
+
+                    SourceParameter {
+                        id: h3GridSource
+                        styleId: "h3"
+                        type: "vector"
+                        property var tiles: [tileServer.tilesUrl("h3")]
+                        property int maxzoom: h3Tiles.maxZoom
+                    }
+
+                    // Значения в тайлах - из активного слоя данных, цвета - по его шкале
+                    LayerParameter {
+                        id: h3FillLayer
+                        styleId: "h3-fill"
+                        type: "fill"
+                        property string source: "h3"
+                        property string sourceLayer: "h3"
+                        layout: ({"visibility": h3Tiles.enabled ? "visible" : "none"})
+                        paint: ({
+                            "fill-color": ["case", ["has", "value"], map.rampExpression(layerManager.activeLayer),
+                                           "rgba(64,128,255,0.5)"],
+                            "fill-opacity": 0.5
+                        })
+                    }
+
+                    LayerParameter {
+                        id: h3LineLayer
+                        styleId: "h3-line"
+                        type: "line"
+                        property string source: "h3"
+                        property string sourceLayer: "h3"
+                        layout: ({"visibility": h3Tiles.enabled ? "visible" : "none"})
+                        paint: ({"line-color": "rgb(0,128,255)", "line-width": 1})
+                    }
+
+                    SourceParameter {
+                        id: h3RasterSource
+                        styleId: "h3raster"
+                        type: "raster"
+                        property var tiles: [tileServer.tilesUrl("h3raster")]
+                        property int tileSize: h3Raster.tileSize
+                        property int maxzoom: h3Raster.maxZoom
+                    }
+
+                    // На крупных зумах слой скрыт: там сетку рисуют векторные тайлы или полигоны
+                    LayerParameter {
+                        id: h3RasterLayer
+                        styleId: "h3-raster"
+                        type: "raster"
+                        property string source: "h3raster"
+                        property int maxzoom: h3Raster.maxZoom + 1
+                        layout: ({"visibility": h3Raster.enabled ? "visible" : "none"})
+                    }
+
+                    SourceParameter {
+                        id: h3ExtrusionSource
+                        styleId: "h3extrusion"
+                        type: "vector"
+                        property var tiles: [tileServer.tilesUrl("h3extrusion")]
+                        property int maxzoom: h3Extrusion.maxZoom
+                    }
+
+                    // Цвет как у h3-fill, высота линейно от 0 до maxHeight на диапазоне шкалы активного слоя
+                    LayerParameter {
+                        id: h3ExtrusionLayer
+                        styleId: "h3-extrusion"
+                        type: "fill-extrusion"
+                        property string source: "h3extrusion"
+                        property string sourceLayer: "h3"
+                        layout: ({"visibility": h3Extrusion.enabled ? "visible" : "none"})
+                        paint: ({
+                            "fill-extrusion-color": map.rampExpression(layerManager.activeLayer),
+                            "fill-extrusion-height": ["interpolate", ["linear"], ["get", "value"],
+                                                      map.rampMin(layerManager.activeLayer), 0,
+                                                      map.rampMax(layerManager.activeLayer), h3Extrusion.maxHeight],
+                            "fill-extrusion-opacity": 0.8
+                        })
+                    }
+                }
+
+                // Шкала слоя данных как выражение MapLibre: опорные цвета равномерно от minValue до maxValue
+                function rampExpression(layer) {
+                    const colors = layer ? layer.colorRamp : [Qt.rgba(0, 0, 1, 1), Qt.rgba(0, 1, 0, 1), Qt.rgba(1, 0, 0, 1)]
+                    const minValue = rampMin(layer)
+                    const maxValue = rampMax(layer)
+                    const expression = ["interpolate", ["linear"], ["get", "value"]]
+                    for (let i = 0; i < colors.length; ++i) {
+                        const color = colors[i]
+                        const position = colors.length > 1 ? i / (colors.length - 1) : 0
+                        expression.push(minValue + (maxValue - minValue) * position)
+                        expression.push("rgba(%1,%2,%3,%4)".arg(Math.round(color.r * 255)).arg(Math.round(color.g * 255))
+                                        .arg(Math.round(color.b * 255)).arg(color.a))
+                    }
+                    return expression
+                }
+
+                // Опорные точки interpolate должны возрастать - пустой диапазон расширяем на единицу
+                function rampMin(layer) {
+                    return layer ? layer.minValue : 0
                 }
 
-                onHeightChanged: {
-                    if (mapReady && height > 0) viewportUpdateTimer.restart()
+                function rampMax(layer) {
+                    return layer && layer.maxValue > layer.minValue ? layer.maxValue : rampMin(layer) + 1
+                }
+
+                // Источник тайлов MapLibre не обновляется на месте: с новой ревизией данных слои и источник
+                // снимаются и добавляются заново, с ревизией в адресе тайлов - старые тайлы не переиспользуются
+                function reloadTileSource(source, layers, name, revision) {
+                    for (const layer of layers)
+                        mapStyle.removeParameter(layer)
+                    mapStyle.removeParameter(source)
+                    source.tiles = [tileServer.tilesUrl(name) + "?v=" + revision]
+                    mapStyle.addParameter(source)
+                    for (const layer of layers)
+                        mapStyle.addParameter(layer)
+                }
+
+                Connections {
+                    target: h3Tiles
+                    function onRevisionChanged() {
+                        map.reloadTileSource(h3GridSource, [h3FillLayer, h3LineLayer], "h3", h3Tiles.revision)
+                    }
+                }
+
+                Connections {
+                    target: h3Raster
+                    function onRevisionChanged() {
+                        map.reloadTileSource(h3RasterSource, [h3RasterLayer], "h3raster", h3Raster.revision)
+                    }
+                }
+
+                Connections {
+                    target: h3Extrusion
+                    function onRevisionChanged() {
+                        map.reloadTileSource(h3ExtrusionSource, [h3ExtrusionLayer], "h3extrusion",
+                                             h3Extrusion.revision)
+                    }
                 }
 
                 // Обработчики мыши
@@ -155,47 +275,95 @@ ApplicationWindow {
                     }
                 }
 
-                // Слой с H3 гексагонами
-                MapItemView {
+                // Слой с H3 гексагонами. Вместо MapItemView - пул: при смене набора ячеек полигоны
+                // не пересоздаются, а получают новые h3Index/boundary
+                H3DelegatePool {
                     id: hexagonLayer
                     model: h3Model
+                    // Когда сетку рисует MapLibre из векторных тайлов, полигоны QML не нужны
+                    // На обзорных зумах при включённом растре полигоны тоже не нужны
+                    visible: (!h3Tiles.enabled && !(h3Raster.enabled && map.zoomLevel < h3Raster.maxZoom + 1))
+                             || h3Model.outlineMode
+
+                    onItemCreated: item => map.addMapItem(item)
+                    onItemReleased: item => map.removeMapItem(item)
 
                     delegate: MapPolygon {
                         id: hexagon
 
-                        // Упрощаем установку path: напрямую используем model.boundary
-                        path: model.boundary || []
+                        // Роли модели, их записывает пул
+                        property string h3Index
+                        property var boundary
+                        property var holes // Только у объединённых контуров
+
+                        geoShape: QtPositioning.polygon(boundary || [], holes || [])
 
                         color: hexagonStyle.fillColor
 
-                        border.color: hexagonStyle.borderColor
-                        border.width: hexagonStyle.borderWidth
+                        // Подсветка под курсором - через привязку, чтобы панель стиля продолжала работать
+                        property bool hovered: false
+
+                        border.color: hovered ? "red" : hexagonStyle.borderColor
+                        border.width: hovered ? hexagonStyle.borderWidth * 4 : hexagonStyle.borderWidth
 
                         opacity: 0.5;
 
+                        // Экземпляр переиспользован для другой ячейки - снимаем подсветку
+                        onH3IndexChanged: hovered = false
+
                         MouseArea {
                             anchors.fill: parent
                             hoverEnabled: true
 
                             onClicked: {
-                                selectedHexagon.text = "H3 Index: " + model.h3Index;
-                                highlightNeighbors(model.h3Index);
+                                selectedHexagon.text = "H3 Index: " + hexagon.h3Index;
+                                highlightNeighbors(hexagon.h3Index);
                             }
 
-                            onEntered: {
-                                hexagon.border.color = "red"
-                                hexagon.border.width = hexagonStyle.borderWidth * 4;
-                            }
+                            onEntered: hexagon.hovered = true
+                            onExited: hexagon.hovered = false
+                        }
+                    }
+                }
 
-                            onExited: {
-                                hexagon.border.color = hexagonStyle.borderColor
-                                hexagon.border.width = hexagonStyle.borderWidth;
-                            }
+                // По одному пулу на слой данных, геометрия общая с hexagonLayer
+                Instantiator {
+                    model: layerManager
+                    delegate: H3DelegatePool {
+                        // Роли менеджера по имени: делегат видит dataLayer и index из контекста Instantiator
+                        model: layerModel
+                        visible: dataLayer.visible && !h3Model.outlineMode
+
+                        onItemCreated: item => map.addMapItem(item)
+                        onItemReleased: item => map.removeMapItem(item)
+
+                        delegate: MapPolygon {
+                            // Роли модели слоя, их записывает пул
+                            property var boundary
+                            property color fillColor
+
+                            path: boundary || []
+                            color: fillColor
+                            opacity: dataLayer.opacity
+                            border.width: 0
+                            z: 1 + index
                         }
                     }
+                    // Слой удалён: сброс делегата уничтожает экземпляры через itemReleased, пока пул жив
+                    onObjectRemoved: (index, object) => object.delegate = null
                 }
             }
 
+            PerfHud {
+                id: perfHud
+                anchors.left: parent.left
+                anchors.top: parent.top
+                anchors.margins: 10
+                visible: false
+                hexagonCount: h3Model.hexagonCount
+                delegatePool: hexagonLayer
+            }
+
             // Информационная панель
             Rectangle {
                 anchors.right: parent.right
@@ -238,6 +406,18 @@ ApplicationWindow {
                         text: "Visible Hexagons: " + h3Model.hexagonCount
                     }
 
+                    Text {
+                        visible: h3Model.outlineMode
+                        text: "Outline Polygons: " + h3Model.outlineCount
+                    }
+
+                    Text {
+                        visible: liveFeed.source !== ""
+                        text: "Live Feed: " + (liveFeed.connected
+                                               ? Math.round(liveFeed.messagesPerSecond) + " msg/s"
+                                               : "disconnected")
+                    }
+
                     Rectangle {
                         width: parent.width
                         height: 1
@@ -361,6 +541,176 @@ ApplicationWindow {
                                     Layout.preferredWidth: 30
                                 }
                             }
+
+                            RowLayout {
+                                spacing: 10
+                                Label {
+                                    text: "Adaptive Resolution:"
+                                    Layout.preferredWidth: implicitWidth
+                                }
+                                Switch {
+                                    checked: h3Model.adaptiveResolution
+                                    onToggled: h3Model.adaptiveResolution = checked
+                                }
+                            }
+
+                            RowLayout {
+                                spacing: 10
+                                enabled: h3Model.adaptiveResolution
+                                Label {
+                                    text: "Cell Size (px):"
+                                    Layout.preferredWidth: implicitWidth
+                                }
+                                Slider {
+                                    id: cellSizeSlider
+                                    from: 24
+                                    to: 256
+                                    value: h3Model.targetCellSize
+                                    stepSize: 8
+                                    Layout.fillWidth: true
+                                    implicitWidth: 150
+                                    onMoved: h3Model.targetCellSize = value
+                                }
+                                Label {
+                                    text: cellSizeSlider.value.toFixed(0)
+                                    Layout.preferredWidth: 30
+                                }
+                            }
+
+                            RowLayout {
+                                spacing: 10
+                                Label {
+                                    text: "Vector Tile Grid:"
+                                    Layout.preferredWidth: implicitWidth
+                                }
+                                Switch {
+                                    checked: h3Tiles.enabled
+                                    onToggled: h3Tiles.enabled = checked
+                                }
+                            }
+
+                            RowLayout {
+                                spacing: 10
+                                Label {
+                                    text: "CPU Raster Overview:"
+                                    Layout.preferredWidth: implicitWidth
+                                }
+                                Switch {
+                                    checked: h3Raster.enabled
+                                    onToggled: h3Raster.enabled = checked
+                                }
+                            }
+
+                            RowLayout {
+                                spacing: 10
+                                Label {
+                                    text: "3D Value Columns:"
+                                    Layout.preferredWidth: implicitWidth
+                                }
+                                Switch {
+                                    checked: h3Extrusion.enabled
+                                    onToggled: {
+                                        h3Extrusion.enabled = checked
+                                        // Столбцы видны только под наклоном
+                                        if (checked && map.tilt < 30)
+                                            map.tilt = 45
+                                    }
+                                }
+                            }
+
+                            RowLayout {
+                                spacing: 10
+                                Label {
+                                    text: "Outline Mode:"
+                                    Layout.preferredWidth: implicitWidth
+                                }
+                                Switch {
+                                    id: outlineModeSwitch
+                                    checked: h3Model.outlineMode
+                                    onToggled: h3Model.outlineMode = checked
+                                }
+                            }
+
+                            RowLayout {
+                                spacing: 10
+                                visible: perfMetrics.enabled
+                                Label {
+                                    text: "Performance HUD (F3):"
+                                    Layout.preferredWidth: implicitWidth
+                                }
+                                Switch {
+                                    checked: perfHud.visible
+                                    onToggled: perfHud.visible = checked
+                                }
+                            }
+                        }
+                    }
+
+                    // Слои данных
+                    GroupBox {
+                        Layout.fillWidth: true
+                        Layout.margins: 10
+                        title: "Data Layers"
+
+                        ColumnLayout {
+                            anchors.fill: parent
+                            spacing: 5
+
+                            Label {
+                                visible: layerManager.count === 0
+                                text: "No data layers"
+                                color: "#808080"
+                            }
+
+                            Repeater {
+                                model: layerManager
+                                delegate: RowLayout {
+                                    spacing: 10
+                                    // Активный слой рисуют тайловые оверлеи MapLibre
+                                    RadioButton {
+                                        checkable: false // Отметка только из привязки, клик меняет сам слой
+                                        checked: layerManager.activeLayer === model.dataLayer
+                                        onClicked: layerManager.activeLayer = model.dataLayer
+                                    }
+                                    CheckBox {
+                                        text: model.name
+                                        checked: model.layerVisible
+                                        onToggled: model.layerVisible = checked
+                                        Layout.fillWidth: true
+                                    }
+                                    Slider {
+                                        from: 0.0
+                                        to: 1.0
+                                        value: model.dataLayer.opacity
+                                        implicitWidth: 100
+                                        onMoved: model.dataLayer.opacity = value
+                                    }
+                                }
+                            }
+
+                            // Воспроизведение временных рядов
+                            RowLayout {
+                                spacing: 10
+                                visible: layerManager.timeBucketCount > 0
+                                Button {
+                                    text: layerManager.playing ? "Pause" : "Play"
+                                    onClicked: layerManager.playing ? layerManager.pause() : layerManager.play()
+                                }
+                                Slider {
+                                    id: timeSlider
+                                    from: 0
+                                    to: Math.max(layerManager.timeBucketCount - 1, 0)
+                                    stepSize: 1
+                                    value: layerManager.currentTime
+                                    Layout.fillWidth: true
+                                    implicitWidth: 150
+                                    onMoved: layerManager.currentTime = value
+                                }
+                                Label {
+                                    text: layerManager.currentTime + "/" + layerManager.timeBucketCount
+                                    Layout.preferredWidth: 50
+                                }
+                            }
                         }
                     }
 